@@ -11,14 +11,29 @@ USE_OLLAMA = True         # Set to False to force GPT fallback
 SUMMARY_FILENAME = "ai_weekly_summary.txt"
 
 # ----------- HELPERS -----------------
+def export_manifest_times(data_dir):
+    """Export name -> unix time from exports/manifest.txt (written by the app), or {} if missing."""
+    times = {}
+    try:
+        with open(os.path.join(data_dir, "exports", "manifest.txt"), "r", encoding="utf-8") as manifest:
+            for line in manifest:
+                parts = line.split(" ", 3)
+                if len(parts) == 4:
+                    times[parts[3].rstrip("\n")] = int(parts[0])
+    except (OSError, ValueError):
+        pass
+    return times
+
 def recent_files_from_patterns(data_dir, patterns, cutoff_days=WEEK_DAYS):
     cutoff = datetime.datetime.now() - datetime.timedelta(days=cutoff_days)
+    manifest = export_manifest_times(data_dir)
     matched_files = set()
     for pat in patterns:
         full_pat = os.path.join(data_dir, pat)
         for f in glob.glob(full_pat):
             try:
-                mtime = datetime.datetime.fromtimestamp(os.path.getmtime(f))
+                t = manifest.get(os.path.basename(f))
+                mtime = datetime.datetime.fromtimestamp(t if t is not None else os.path.getmtime(f))
                 if mtime >= cutoff:
                     matched_files.add(f)
             except Exception:
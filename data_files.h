@@ -0,0 +1,109 @@
+// data_files.h
+// Productivity Tracker - parsers for the human-readable data files.
+//   daily_logs.txt   "YYYY-MM-DD HH:MM:SS - TYPE - text"   (older lines may lack the TYPE)
+//   tasks.txt        "N: [x] name (parent=P)"
+//
+// Used by main.cpp (load_daily_logs/load_tasks when migrating a data directory) and
+// pt_aggregate.cpp, so the team tool reads the files exactly like the app does.
+// Header-only; no dependencies beyond the standard library.
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+// Local time "YYYY-MM-DD HH:MM:SS" to time_t; the current time if `s` does not parse.
+// The fixed-width form skips sscanf, and mktime (which takes a global timezone lock
+// in libc) runs twice per hour of log rather than once per line: the per-thread cache
+// holds the start of the last hour seen.
+static inline time_t pt_parse_timestamp(const char* s, size_t n) {
+    auto dig = [](char c) { return c >= '0' && c <= '9'; };
+    int y, m, d, hh, mm, ss;
+    if (n >= 19 && s[4] == '-' && s[7] == '-' && s[10] == ' ' && s[13] == ':' && s[16] == ':' &&
+        dig(s[0]) && dig(s[1]) && dig(s[2]) && dig(s[3]) && dig(s[5]) && dig(s[6]) && dig(s[8]) && dig(s[9]) &&
+        dig(s[11]) && dig(s[12]) && dig(s[14]) && dig(s[15]) && dig(s[17]) && dig(s[18])) {
+        y = (s[0]-'0')*1000 + (s[1]-'0')*100 + (s[2]-'0')*10 + (s[3]-'0');
+        m = (s[5]-'0')*10 + (s[6]-'0'); d = (s[8]-'0')*10 + (s[9]-'0');
+        hh = (s[11]-'0')*10 + (s[12]-'0'); mm = (s[14]-'0')*10 + (s[15]-'0'); ss = (s[17]-'0')*10 + (s[18]-'0');
+    } else {
+        std::string tmp(s, n);
+        if (sscanf(tmp.c_str(), "%4d-%2d-%2d %2d:%2d:%2d", &y,&m,&d,&hh,&mm,&ss) != 6) return time(nullptr);
+    }
+    if (mm < 60 && ss < 60) {
+        static thread_local int64_t cachedKey = -1;
+        static thread_local time_t cachedHour = 0;
+        int64_t key = (((int64_t)y * 16 + m) * 32 + d) * 32 + hh;
+        if (key != cachedKey) {
+            // Only hours without a UTC offset change inside them are cached (some zones
+            // shift by 30 minutes); for those the offset within the hour is linear.
+            struct tm a{}, b{};
+            a.tm_year = b.tm_year = y - 1900; a.tm_mon = b.tm_mon = m - 1; a.tm_mday = b.tm_mday = d;
+            a.tm_hour = b.tm_hour = hh; a.tm_isdst = b.tm_isdst = -1;
+            b.tm_min = 59; b.tm_sec = 59;
+            time_t t = mktime(&a), t2 = mktime(&b);
+            if (t != (time_t)-1 && t2 - t == 3599 && a.tm_hour == hh && b.tm_hour == hh) { cachedKey = key; cachedHour = t; }
+        }
+        if (key == cachedKey) return cachedHour + mm * 60 + ss;
+    }
+    struct tm tm{};
+    tm.tm_year = y - 1900; tm.tm_mon = m - 1; tm.tm_mday = d;
+    tm.tm_hour = hh; tm.tm_min = mm; tm.tm_sec = ss; tm.tm_isdst = -1;
+    time_t t = mktime(&tm);
+    return t != (time_t)-1 ? t : time(nullptr);
+}
+static inline time_t pt_parse_timestamp(const std::string &s) { return pt_parse_timestamp(s.data(), s.size()); }
+
+// One daily_logs.txt line. Returns false for an empty line. Lines without " - " are
+// kept as LOG entries stamped with the current time, as the app always did.
+static inline bool pt_parse_log_line(const std::string &line, time_t &ts, std::string &type, std::string &text) {
+    if (line.empty()) return false;
+    size_t firstDash = line.find(" - ");
+    if (firstDash == std::string::npos) {
+        ts = time(nullptr); type = "LOG"; text = line;
+        return true;
+    }
+    ts = pt_parse_timestamp(line.data(), firstDash);
+    size_t secondDash = line.find(" - ", firstDash + 3);
+    if (secondDash != std::string::npos) {
+        type.assign(line, firstDash + 3, secondDash - (firstDash + 3));
+        size_t restStart = secondDash + 3;
+        if (restStart < line.size()) text.assign(line, restStart, std::string::npos); else text.clear();
+    } else {
+        type = "LOG";
+        text.assign(line, firstDash + 3, std::string::npos);
+    }
+    return true;
+}
+
+// One tasks.txt line. Returns false for an empty line.
+static inline bool pt_parse_task_line(const std::string &line, std::string &name, int &parent, bool &done) {
+    if (line.empty()) return false;
+    size_t colon = line.find(':');
+    std::string rest = (colon == std::string::npos) ? line : line.substr(colon + 1);
+    size_t pos = rest.find_first_not_of(" \t");
+    if (pos != std::string::npos) rest = rest.substr(pos);
+    done = false;
+    if (rest.size() >= 3 && rest[0] == '[' && rest[2] == ']') {
+        done = (rest[1] == 'x' || rest[1] == 'X');
+        size_t br = rest.find(']');
+        if (br != std::string::npos) rest = rest.substr(br + 1);
+        pos = rest.find_first_not_of(" \t");
+        if (pos != std::string::npos) rest = rest.substr(pos);
+    }
+    parent = -1;
+    size_t ppos = rest.rfind("(parent=");
+    if (ppos != std::string::npos) {
+        size_t endp = rest.find(')', ppos);
+        if (endp != std::string::npos) {
+            std::string num = rest.substr(ppos + 8, endp - (ppos + 8));
+            try { parent = std::stoi(num); } catch(...) { parent = -1; }
+            rest = rest.substr(0, ppos);
+            while (!rest.empty() && isspace((unsigned char)rest.back())) rest.pop_back();
+        }
+    }
+    name = rest;
+    return true;
+}
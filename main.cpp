@@ -18,11 +18,38 @@
 #include "imgui.h"
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
+#include "status_page.h"
+#include "data_files.h"
+#ifdef PT_HAVE_SQLITE
+  #include <sqlite3.h>
+#endif
 
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <errno.h>
+#ifndef _WIN32
+  #include <unistd.h>
+  #include <fcntl.h>
+  #include <spawn.h>
+  #include <signal.h>
+  #include <sys/wait.h>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <sys/file.h>
+  #include <dirent.h>
+  #include <netinet/in.h>
+  #include <arpa/inet.h>
+  extern char **environ;
+#endif
+#ifdef __linux__
+  #include <sys/epoll.h>
+  #include <sys/eventfd.h>
+  #include <sys/inotify.h>
+  #include <poll.h>
+#endif
 
+#include <cfloat>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -36,10 +63,24 @@
 #include <thread>
 #include <atomic>
 #include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <set>
+#include <cctype>
+#include <functional>
+#include <csignal>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <algorithm>
 
 #ifdef _WIN32
   #include <windows.h>
 #include <direct.h>
+#include <io.h>
 #endif
 
 // --------------------------- Forward declarations --------------------------
@@ -49,45 +90,305 @@ static void end_last_break_of_type(const std::string &type);
 static void add_task(const std::string &name, int parent_idx);
 static void append_daily_log(const char* type, const std::string &text);
 static std::string export_text_to_file(const char* prefix, const char* content);
-static std::string export_hourly_logs_today();
-static std::string export_weekly_logs_file();
+static void put_u32(std::string &b, uint32_t v);
+static void put_u64(std::string &b, uint64_t v);
+static uint32_t crc32_update(uint32_t crc, const unsigned char* data, size_t n);
+static uint64_t fnv1a(const std::string &s, uint64_t h);
+static bool write_file_atomic(const std::string &path, const std::string &bytes);
+static bool read_whole_file(const std::string &path, std::string &out);
+static void export_hourly_logs_today();
+static void export_weekly_logs_file();
 static void save_daily_status_to_disk_and_log(const std::string &text);
 static void save_weekly_status_to_disk_and_log(const std::string &text);
 static void save_tasks();
 static void end_day_action();
 static void launch_analysis_script();
+static void wal_recover();
+static void wal_shutdown();
+static void storage_begin_batch();
+static void storage_end_batch();
+static bool live_reload_append_own(const std::string &path, const std::string &bytes, uint64_t &begin, uint64_t &end);
+static void live_reload_note_own_tasks(const std::string &content);
+static bool live_reload_running();
+static bool instance_is_secondary();
+static bool instance_forward(const std::string &command);
+static std::string ipc_escape(const std::string &s);
+static void removeTaskAndChildren(int idx);
+static void app_start_primary_services();
+
+// ----------------------- Allocation counting -------------------------------
+// Opt-in counters of heap allocations made by the calling thread, for the profiler
+// window and the --headless-frames allocation budget. Covers operator new and ImGui's
+// own allocator (hooked in main). Off by default: the hooks then cost one relaxed
+// atomic load per allocation. Enable with PT_COUNT_ALLOCS=1 or View > Profiler.
+struct AllocCounters {
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0;
+};
+static std::atomic<bool> allocCountingEnabled(false);
+static thread_local AllocCounters tlAllocCounters;
+
+static inline void count_alloc(size_t n) {
+    if (allocCountingEnabled.load(std::memory_order_relaxed)) { ++tlAllocCounters.allocs; tlAllocCounters.bytes += n; }
+}
+static inline void count_free(void* p) {
+    if (p && allocCountingEnabled.load(std::memory_order_relaxed)) ++tlAllocCounters.frees;
+}
+static void* counted_malloc(size_t n) {
+    count_alloc(n);
+    return std::malloc(n ? n : 1);
+}
+static void counted_free(void* p) {
+    count_free(p);
+    std::free(p);
+}
+static void* imgui_counted_alloc(size_t n, void*) { return counted_malloc(n); }
+static void imgui_counted_free(void* p, void*) { counted_free(p); }
+
+void* operator new(size_t n) {
+    if (void* p = counted_malloc(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) {
+    if (void* p = counted_malloc(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return counted_malloc(n); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return counted_malloc(n); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t) noexcept { counted_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+
+// ----------------------- Job pool ------------------------------------------
+// Small fixed-size work-stealing pool owned by main() (started before the UI loop,
+// drained and joined on shutdown). Each worker has one deque per priority; idle
+// workers steal from the others. High is for short jobs whose result the user is
+// waiting on (alerts); Low is for bulk work (exports, snapshots, analysis).
+// Results that touch app state are handed back with post_to_ui() and run on the UI
+// thread by run_ui_completions() once per frame.
+enum class JobPriority { High = 0, Low = 1 };
+
+class JobPool {
+public:
+    void start(unsigned n) {
+        if (!workers_.empty()) return;
+        if (n < 2) n = 2;
+        queues_.reset(new Queue[n]);
+        nqueues_ = n;
+        for (unsigned i = 0; i < n; ++i) workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+    void submit(std::function<void()> fn, JobPriority prio) {
+        if (workers_.empty()) { fn(); return; } // not started (or already shut down): run inline
+        unsigned q = next_.fetch_add(1) % nqueues_;
+        {
+            std::lock_guard<std::mutex> lock(queues_[q].mutex);
+            queues_[q].jobs[(int)prio].push_back(std::move(fn));
+        }
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            ++queued_;
+        }
+        wake_cv_.notify_one();
+    }
+    // Runs every queued job to completion, then joins the workers.
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stop_ = true;
+        }
+        wake_cv_.notify_all();
+        for (auto &t : workers_) t.join();
+        workers_.clear();
+    }
+    size_t size() const { return workers_.size(); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs[2];
+    };
+    // Own queue first (FIFO), then steal from the back of the others; High before Low.
+    bool try_take(unsigned self, std::function<void()> &out) {
+        for (int prio = 0; prio < 2; ++prio) {
+            for (unsigned k = 0; k < nqueues_; ++k) {
+                Queue &q = queues_[(self + k) % nqueues_];
+                std::lock_guard<std::mutex> lock(q.mutex);
+                auto &dq = q.jobs[prio];
+                if (dq.empty()) continue;
+                if (k == 0) { out = std::move(dq.front()); dq.pop_front(); }
+                else { out = std::move(dq.back()); dq.pop_back(); }
+                return true;
+            }
+        }
+        return false;
+    }
+    void worker_loop(unsigned self) {
+        for (;;) {
+            std::function<void()> job;
+            if (try_take(self, job)) {
+                {
+                    std::lock_guard<std::mutex> lock(wake_mutex_);
+                    --queued_;
+                }
+                job();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait(lock, [this] { return queued_ > 0 || stop_; });
+            if (stop_ && queued_ == 0) return;
+        }
+    }
+
+    std::unique_ptr<Queue[]> queues_;
+    unsigned nqueues_ = 0;
+    std::vector<std::thread> workers_;
+    std::atomic<unsigned> next_{0};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    int queued_ = 0;
+    bool stop_ = false;
+};
+static JobPool jobPool;
+
+static std::mutex ui_completions_mutex;
+static std::vector<std::function<void()>> ui_completions;
+
+static void post_to_ui(std::function<void()> fn) {
+    std::lock_guard<std::mutex> lock(ui_completions_mutex);
+    ui_completions.push_back(std::move(fn));
+}
+static void run_ui_completions() {
+    std::vector<std::function<void()>> pending;
+    {
+        std::lock_guard<std::mutex> lock(ui_completions_mutex);
+        pending.swap(ui_completions);
+    }
+    for (auto &fn : pending) fn();
+}
 
 // ----------------------- Cross-platform alert (best-effort) ----------------
-static void play_alert_sound() {
+// The player is probed once at startup (PATH lookup, no shell) and alerts are played
+// on the job pool. Sinks are pluggable;
+// PT_ALERT_SINK=record selects a sink that only records alerts (headless checks),
+// PT_ALERT_SINK=bell forces the terminal bell and PT_ALERT_SINK=off disables sound.
+struct AlertSink {
+    virtual ~AlertSink() {}
+    virtual const char* name() const = 0;
+    virtual void play() = 0; // called on the alert worker thread
+};
+
+struct BellAlertSink : AlertSink {
+    const char* name() const override { return "bell"; }
+    void play() override {
 #ifdef _WIN32
-    // Use MessageBeep for a quick attention sound
-    for (int i = 0; i < 2; ++i) {
         MessageBeep(MB_ICONEXCLAMATION);
-        Sleep(160);
-    }
-#elif defined(__APPLE__)
-    // macOS: afplay is typically available
-    system("afplay /System/Library/Sounds/Glass.aiff >/dev/null 2>&1 &");
 #else
-    // Linux: try a set of common players, fall back to BEL
-    if (system("which paplay >/dev/null 2>&1") == 0) {
-        system("paplay /usr/share/sounds/freedesktop/stereo/bell.oga >/dev/null 2>&1 &");
-    } else if (system("which aplay >/dev/null 2>&1") == 0) {
-        system("aplay /usr/share/sounds/alsa/Front_Center.wav >/dev/null 2>&1 &");
-    } else if (system("which play >/dev/null 2>&1") == 0) {
-        system("play -q /usr/share/sounds/alsa/Noise.wav >/dev/null 2>&1 &");
-    } else {
         // Last resort: ASCII BEL (may be quiet or ignored)
         std::cout << '\a' << std::flush;
+#endif
+    }
+};
+
+struct NullAlertSink : AlertSink {
+    const char* name() const override { return "off"; }
+    void play() override {}
+};
+
+// Records every alert instead of playing it
+struct RecordingAlertSink : AlertSink {
+    std::mutex mutex;
+    std::vector<time_t> played;
+    const char* name() const override { return "record"; }
+    void play() override { std::lock_guard<std::mutex> lock(mutex); played.push_back(time(nullptr)); }
+    size_t count() { std::lock_guard<std::mutex> lock(mutex); return played.size(); }
+};
+
+#ifndef _WIN32
+// Runs `player sound` directly via posix_spawn and waits for it (on the worker thread).
+struct CommandAlertSink : AlertSink {
+    std::string player, sound, label;
+    CommandAlertSink(const std::string &p, const std::string &s, const std::string &l) : player(p), sound(s), label(l) {}
+    const char* name() const override { return label.c_str(); }
+    void play() override {
+        posix_spawn_file_actions_t fa;
+        posix_spawn_file_actions_init(&fa);
+        posix_spawn_file_actions_addopen(&fa, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_addopen(&fa, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+        std::vector<const char*> argv;
+        argv.push_back(player.c_str());
+        if (label == "play") argv.push_back("-q");
+        argv.push_back(sound.c_str());
+        argv.push_back(nullptr);
+        pid_t pid = -1;
+        if (posix_spawn(&pid, player.c_str(), &fa, nullptr, const_cast<char* const*>(argv.data()), environ) == 0)
+            waitpid(pid, nullptr, 0);
+        posix_spawn_file_actions_destroy(&fa);
+    }
+};
+
+static std::string find_in_path(const char* exe) {
+    const char* path = getenv("PATH");
+    if (!path) return std::string();
+    std::string p(path);
+    size_t start = 0;
+    while (start <= p.size()) {
+        size_t end = p.find(':', start);
+        if (end == std::string::npos) end = p.size();
+        std::string candidate = (end > start ? p.substr(start, end - start) : std::string(".")) + "/" + exe;
+        if (access(candidate.c_str(), X_OK) == 0) return candidate;
+        start = end + 1;
+    }
+    return std::string();
+}
+#endif
+
+static std::unique_ptr<AlertSink> probe_alert_sink() {
+    const char* forced = getenv("PT_ALERT_SINK");
+    if (forced) {
+        if (std::strcmp(forced, "record") == 0) return std::unique_ptr<AlertSink>(new RecordingAlertSink());
+        if (std::strcmp(forced, "bell") == 0) return std::unique_ptr<AlertSink>(new BellAlertSink());
+        if (std::strcmp(forced, "off") == 0) return std::unique_ptr<AlertSink>(new NullAlertSink());
+    }
+#if defined(__APPLE__)
+    // macOS: afplay is typically available
+    std::string afplay = find_in_path("afplay");
+    if (!afplay.empty()) return std::unique_ptr<AlertSink>(new CommandAlertSink(afplay, "/System/Library/Sounds/Glass.aiff", "afplay"));
+#elif !defined(_WIN32)
+    // Linux: try a set of common players, fall back to BEL
+    struct Candidate { const char* exe; const char* sound; };
+    static const Candidate candidates[] = {
+        { "paplay", "/usr/share/sounds/freedesktop/stereo/bell.oga" },
+        { "aplay",  "/usr/share/sounds/alsa/Front_Center.wav" },
+        { "play",   "/usr/share/sounds/alsa/Noise.wav" },
+    };
+    for (const auto &c : candidates) {
+        std::string exe = find_in_path(c.exe);
+        if (!exe.empty()) return std::unique_ptr<AlertSink>(new CommandAlertSink(exe, c.sound, c.exe));
     }
 #endif
+    return std::unique_ptr<AlertSink>(new BellAlertSink());
+}
+
+static std::unique_ptr<AlertSink> alertSink;
+static std::atomic<bool> alert_in_flight(false);
+
+static void alert_init() {
+    alertSink = probe_alert_sink();
 }
+// Alerts run as High-priority pool jobs; requests made while one is playing are dropped.
 static void play_alert_async() {
-    std::thread([](){
-        play_alert_sound();
+    if (!alertSink || alert_in_flight.exchange(true)) return;
+    jobPool.submit([] {
+        // Two short chimes, as before
+        alertSink->play();
         std::this_thread::sleep_for(std::chrono::milliseconds(150));
-        play_alert_sound();
-    }).detach();
+        alertSink->play();
+        alert_in_flight.store(false);
+    }, JobPriority::High);
 }
 
 // ----------------------- App constants & state ----------------------------
@@ -105,6 +406,7 @@ struct DailyLog {
     time_t ts;
     std::string type; // "HOURLY", "DAILY_STATUS", "WEEKLY_STATUS", ...
     std::string text;
+    uint8_t style = 0; // index into logStyles, stamped when the entry is indexed
 };
 
 struct BreakEntry { std::string type; time_t start = 0; time_t end = 0; };
@@ -113,6 +415,7 @@ struct Task { std::string name; int parent = -1; bool done = false; };
 static std::vector<DailyLog> dailyLogs;
 static std::vector<BreakEntry> breaks;
 static std::vector<Task> tasks;
+static uint64_t tasks_version = 0; // bumped when tasks are added, removed or reloaded (names/indices change)
 static int new_task_parent_idx = -1;
 
 static std::mt19937 rng((unsigned)std::time(nullptr));
@@ -128,6 +431,11 @@ static time_t app_start_time = 0;
 static time_t tracking_start_time = 0;
 static long accumulated_tracked_seconds = 0;
 
+// Seconds tracked in this session as of `now` (excludes breaks).
+static long tracked_seconds_at(time_t now) {
+    return accumulated_tracked_seconds + ((tracking_start_time == 0) ? 0L : (long)(now - tracking_start_time));
+}
+
 // Helper to format an elapsed duration (seconds) as Dd HH:MM:SS or HH:MM:SS
 static std::string format_duration_seconds(time_t seconds) {
     long s = (long)seconds;
@@ -143,15 +451,45 @@ static std::string format_duration_seconds(time_t seconds) {
     return oss.str();
 }
 
-// Helper: count currently active breaks (end == 0)
-static int active_breaks_count() {
-    int c = 0;
-    for (const auto &b : breaks) if (b.end == 0) ++c;
-    return c;
+// Active-break index: a running count plus a per-type stack of indices into `breaks`
+// for entries with end == 0. Maintained on every break start/end so neither
+// start_break() nor end_last_break_of_type() has to scan the break history.
+static int active_break_total = 0;
+static std::unordered_map<std::string, std::vector<int>> active_breaks_by_type;
+
+static int active_breaks_count() { return active_break_total; }
+static int last_active_break_of_type(const std::string &type) {
+    auto it = active_breaks_by_type.find(type);
+    if (it == active_breaks_by_type.end() || it->second.empty()) return -1;
+    return it->second.back();
+}
+static void index_break_started(int idx) {
+    active_breaks_by_type[breaks[idx].type].push_back(idx);
+    ++active_break_total;
+}
+static void index_break_ended(int idx) {
+    std::vector<int> &stack = active_breaks_by_type[breaks[idx].type];
+    // Usually the most recent break of its type; the breaks table can end older ones too
+    if (!stack.empty() && stack.back() == idx) stack.pop_back();
+    else {
+        auto it = std::find(stack.begin(), stack.end(), idx);
+        if (it == stack.end()) return;
+        stack.erase(it);
+    }
+    --active_break_total;
+}
+static void rebuild_active_break_index() {
+    active_breaks_by_type.clear();
+    active_break_total = 0;
+    for (int i = 0; i < (int)breaks.size(); ++i)
+        if (breaks[i].end == 0) index_break_started(i);
 }
 
 // ----------------------- File/time helpers --------------------------------
 static std::string user_data_dir() {
+    // PT_DATA_DIR overrides the location (used by --headless-frames runs)
+    const char* over = getenv("PT_DATA_DIR");
+    if (over && *over) return std::string(over);
     const char* home = getenv("HOME");
 #ifdef _WIN32
     if (!home) home = getenv("USERPROFILE");
@@ -198,17 +536,7 @@ static std::string format_iso_time(time_t t) {
     std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
     return std::string(buf);
 }
-static time_t parse_timestamp(const std::string &s) {
-    struct tm tm{};
-    int y,m,d,hh,mm,ss;
-    if (sscanf(s.c_str(), "%4d-%2d-%2d %2d:%2d:%2d", &y,&m,&d,&hh,&mm,&ss) == 6) {
-        tm.tm_year = y - 1900; tm.tm_mon = m - 1; tm.tm_mday = d;
-        tm.tm_hour = hh; tm.tm_min = mm; tm.tm_sec = ss; tm.tm_isdst = -1;
-        time_t t = mktime(&tm);
-        if (t != (time_t)-1) return t;
-    }
-    return time(nullptr);
-}
+static time_t parse_timestamp(const std::string &s) { return pt_parse_timestamp(s); }
 static std::string human_log_line(const char* type, const std::string &text, time_t ts = 0) {
     time_t t = ts ? ts : time(nullptr);
     std::ostringstream oss;
@@ -221,7 +549,8 @@ static bool append_line_to_file(const std::string &path, const std::string &line
     f << line << "\n";
     return true;
 }
-static std::string export_text_to_file(const char* prefix, const char* content) {
+// "<prefix>_YYYYmmdd_HHMMSS<ext>" in the data dir.
+static std::string export_file_path(const char* prefix, const char* ext) {
     time_t now = time(nullptr);
     struct tm tm{};
 #if defined(_WIN32)
@@ -232,518 +561,5727 @@ static std::string export_text_to_file(const char* prefix, const char* content)
     char ts[32];
     std::strftime(ts, sizeof(ts), "%Y%m%d_%H%M%S", &tm);
     std::ostringstream filename;
-    filename << prefix << "_" << ts << ".txt";
-    std::string path = path_in_data(filename.str().c_str());
-    std::ofstream f(path);
-    if (!f) return std::string();
-    f << content << "\n";
-    return path;
+    filename << prefix << "_" << ts << ext;
+    return path_in_data(filename.str().c_str());
 }
 
-// ----------------------- Exports: hourly/weekly ---------------------------
-static bool is_same_local_day(time_t a, time_t b) {
-    struct tm ta{}, tb{};
-#if defined(_WIN32)
-    localtime_s(&ta, &a);
-    localtime_s(&tb, &b);
+// ----------------------- Export storage -----------------------------------
+// Export contents are stored once, by hash, as exports/objects/<fnv1a64>-<size>. The
+// timestamped name in the data dir (daily_status_saved_20250101_120000.txt, ...) is a
+// hard link to the object (a symlink, or a plain copy, where that fails). Saving the
+// same text again adds a name but no data. Names of one object share its mtime, so
+// the manifest's time is the one to go by.
+//
+// exports/manifest.txt lists the export names, so tools need not glob and stat the
+// data dir. One line per export:
+//   <unix time> <object, or - for a file stored directly> <size> <file name>
+// At startup the primary instance runs export_store_maintain() on the job pool: it
+// adopts export files written before the manifest existed, applies the retention
+// policy (export_retention.txt: "keep_days N", "keep_last N"; names older than
+// keep_days go, except the newest keep_last of each kind) and deletes unreferenced
+// objects.
+static const char* EXPORT_STORE_DIR = "exports";
+static const char* EXPORT_MANIFEST_FILE = "exports/manifest.txt";
+static const char* EXPORT_RETENTION_FILE = "export_retention.txt";
+static const int kExportKeepDaysDefault = 90;
+static const int kExportKeepLastDefault = 20;
+static const uint64_t kExportAdoptMaxBytes = 1 << 20; // larger legacy files are kept as they are
+static const char* const kExportPrefixes[] = {
+    "daily_status_saved", "weekly_status_saved", "daily_status_end_of_day", "weekly_status_end_of_day",
+    "daily_status_export", "weekly_status_export", "hourly_logs_today", "weekly_logs_export",
+};
+static std::mutex exportStoreMutex; // exports are written from the UI thread and from jobs
+
+struct ExportManifestEntry {
+    int64_t time = 0;
+    std::string object;
+    uint64_t size = 0;
+    std::string name;
+};
+
+static std::string export_objects_dir() {
+    std::string store = path_in_data(EXPORT_STORE_DIR);
+    std::string objects = store + "/objects";
+    if (!ensure_dir_exists(store) || !ensure_dir_exists(objects)) return std::string();
+    return objects;
+}
+static std::string export_object_name(const std::string &bytes) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%016llx-%llx", (unsigned long long)fnv1a(bytes, 1469598103934665603ull), (unsigned long long)bytes.size());
+    return buf;
+}
+static std::string path_basename(const std::string &path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+static bool write_plain_file(const std::string &path, const std::string &bytes) {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f.write(bytes.data(), (std::streamsize)bytes.size());
+    return (bool)f;
+}
+// File names in `dir` (no "." / "..").
+static std::vector<std::string> list_directory(const std::string &dir) {
+    std::vector<std::string> names;
+#ifdef _WIN32
+    struct _finddata_t fd;
+    intptr_t h = _findfirst((dir + "/*").c_str(), &fd);
+    if (h == -1) return names;
+    do {
+        if (std::strcmp(fd.name, ".") != 0 && std::strcmp(fd.name, "..") != 0) names.push_back(fd.name);
+    } while (_findnext(h, &fd) == 0);
+    _findclose(h);
+#else
+    DIR* d = opendir(dir.c_str());
+    if (!d) return names;
+    while (struct dirent* e = readdir(d)) {
+        if (std::strcmp(e->d_name, ".") != 0 && std::strcmp(e->d_name, "..") != 0) names.push_back(e->d_name);
+    }
+    closedir(d);
+#endif
+    return names;
+}
+
+// Points `path` at the object (`bytes` is its content, for the copy fallback).
+static bool export_link(const std::string &objPath, const std::string &path, const std::string &bytes) {
+    std::remove(path.c_str());
+#ifdef _WIN32
+    if (CreateHardLinkA(path.c_str(), objPath.c_str(), nullptr)) return true;
 #else
-    localtime_r(&a, &ta);
-    localtime_r(&b, &tb);
+    if (link(objPath.c_str(), path.c_str()) == 0) return true;
+    // Relative, so the data dir can be moved
+    std::string target = std::string(EXPORT_STORE_DIR) + "/objects/" + path_basename(objPath);
+    if (symlink(target.c_str(), path.c_str()) == 0) return true;
 #endif
-    return (ta.tm_year==tb.tm_year && ta.tm_mon==tb.tm_mon && ta.tm_mday==tb.tm_mday);
+    return write_plain_file(path, bytes);
 }
-static std::string export_hourly_logs_today() {
-    if (dailyLogs.empty()) return std::string();
-    time_t now = time(nullptr);
-    std::ostringstream content;
-    for (const auto &d : dailyLogs) {
-        if (d.type == "HOURLY" && is_same_local_day(now, d.ts)) {
-            content << human_log_line(d.type.c_str(), d.text, d.ts) << "\n";
-        }
+// Stores `bytes` as an object (or finds it already stored) and links `path` to it. A
+// name collision with different content falls back to a plain file.
+static bool export_store_object(const std::string &path, const std::string &bytes, std::string &object) {
+    std::string dir = export_objects_dir();
+    object = export_object_name(bytes);
+    std::string objPath = dir + "/" + object;
+    std::string existing;
+    bool stored = false;
+    if (!dir.empty() && read_whole_file(objPath, existing)) {
+        stored = existing == bytes;
+    } else if (!dir.empty()) {
+        // Write-then-rename, without the fsync: an export is not worth a stall. The
+        // maintenance job stores objects too, without the lock, hence the unique name.
+        static std::atomic<unsigned> tmpCounter{0};
+        std::string tmp = objPath + ".tmp" + std::to_string(tmpCounter.fetch_add(1));
+        stored = write_plain_file(tmp, bytes) && std::rename(tmp.c_str(), objPath.c_str()) == 0;
     }
-    if (content.str().empty()) return std::string();
-    return export_text_to_file("hourly_logs_today", content.str().c_str());
+    if (stored && export_link(objPath, path, bytes)) return true;
+    object = "-";
+    return write_plain_file(path, bytes);
 }
-static std::string json_escape(const std::string &s) {
-    std::string out;
-    out.reserve(s.size());
-    for (char c : s) {
-        switch (c) {
-        case '\\': out += "\\\\"; break;
-        case '\"': out += "\\\""; break;
-        case '\n': out += "\\n"; break;
-        case '\r': out += "\\r"; break;
-        case '\t': out += "\\t"; break;
-        default: out += c; break;
-        }
+static std::string format_manifest_line(const ExportManifestEntry &e) {
+    return std::to_string(e.time) + " " + e.object + " " + std::to_string(e.size) + " " + e.name + "\n";
+}
+static void export_manifest_append(const ExportManifestEntry &e) {
+    if (export_objects_dir().empty()) return;
+    std::ofstream f(path_in_data(EXPORT_MANIFEST_FILE), std::ios::binary | std::ios::app);
+    f << format_manifest_line(e);
+}
+
+// Stores `bytes` under the given export path (a name from export_file_path()).
+static std::string export_store_at(const std::string &path, const std::string &bytes) {
+    if (instance_is_secondary()) return std::string(); // the primary owns the export store
+    std::lock_guard<std::mutex> lock(exportStoreMutex);
+    ExportManifestEntry e;
+    if (!export_store_object(path, bytes, e.object)) return std::string();
+    e.time = (int64_t)time(nullptr);
+    e.size = bytes.size();
+    e.name = path_basename(path);
+    export_manifest_append(e);
+    return path;
+}
+static std::string export_store(const char* prefix, const char* ext, const std::string &bytes) {
+    return export_store_at(export_file_path(prefix, ext), bytes);
+}
+static std::string export_text_to_file(const char* prefix, const char* content) {
+    return export_store(prefix, ".txt", std::string(content) + "\n");
+}
+// Lists an export that was written in place (the weekly logs export is assembled directly).
+static void export_store_register(const std::string &path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return;
+    std::lock_guard<std::mutex> lock(exportStoreMutex);
+    ExportManifestEntry e;
+    e.time = (int64_t)time(nullptr);
+    e.object = "-";
+    e.size = (uint64_t)st.st_size;
+    e.name = path_basename(path);
+    export_manifest_append(e);
+}
+
+// "<prefix>_YYYYmmdd_HHMMSS<ext>" with a known prefix: returns "<prefix><ext>", else "".
+static std::string export_kind(const std::string &name) {
+    size_t dot = name.rfind('.');
+    if (dot == std::string::npos || dot < 17) return std::string();
+    std::string ext = name.substr(dot);
+    if (ext != ".txt" && ext != ".ptcol") return std::string();
+    size_t stamp = dot - 16;
+    for (size_t i = 0; i < 16; ++i) {
+        char c = name[stamp + i];
+        if ((i == 0 || i == 9) ? c != '_' : !std::isdigit((unsigned char)c)) return std::string();
     }
-    return out;
+    std::string prefix = name.substr(0, stamp);
+    for (const char* p : kExportPrefixes) if (prefix == p) return prefix + ext;
+    return std::string();
 }
-static std::string export_weekly_logs_file() {
-    if (dailyLogs.empty()) return std::string();
 
-    time_t now = time(nullptr);
-    const time_t week_seconds = 7 * 24 * 60 * 60;
-    time_t cutoff = now - week_seconds;
+// Manifest entries, one per name (a same-second re-export replaces the earlier line).
+static std::vector<ExportManifestEntry> export_manifest_read() {
+    std::vector<ExportManifestEntry> entries;
+    std::unordered_map<std::string, size_t> byName;
+    std::ifstream f(path_in_data(EXPORT_MANIFEST_FILE));
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream ls(line);
+        ExportManifestEntry e;
+        if (!(ls >> e.time >> e.object >> e.size >> e.name)) continue;
+        auto it = byName.find(e.name);
+        if (it != byName.end()) entries[it->second] = e;
+        else { byName.emplace(e.name, entries.size()); entries.push_back(e); }
+    }
+    return entries;
+}
 
-    std::ostringstream human_section;
-    std::ostringstream hourly_jsonl_section;
+// The data dir scan, adoption and retention run without exportStoreMutex, so exports
+// made meanwhile (from the UI thread) never wait for them. The manifest merge and the
+// object cleanup run under it: an export renames its object into place before linking
+// a name to it, and only the manifest read under the lock lists every live object.
+static void export_store_maintain() {
+    jobPool.submit([]() {
+        std::string objDir = export_objects_dir();
+        if (objDir.empty()) return;
+        std::string dataDir = user_data_dir();
+        int keepDays = kExportKeepDaysDefault, keepLast = kExportKeepLastDefault;
+        {
+            std::ifstream cfg(path_in_data(EXPORT_RETENTION_FILE));
+            std::string line;
+            while (std::getline(cfg, line)) {
+                std::istringstream ls(line);
+                std::string key;
+                int value = 0;
+                if (!(ls >> key >> value) || key[0] == '#') continue;
+                if (key == "keep_days") keepDays = std::max(0, value);
+                else if (key == "keep_last") keepLast = std::max(0, value);
+            }
+        }
 
-    human_section << "WEEKLY LOG EXPORT\n";
-    human_section << "Generated: " << format_time_local(now) << "\n";
-    human_section << "Range: last 7 days\n\n";
+        std::vector<ExportManifestEntry> entries = export_manifest_read();
+        std::unordered_map<std::string, bool> listed;
+        for (const auto &e : entries) listed[e.name] = true;
+
+        // Adopt export files that predate the manifest
+        std::vector<ExportManifestEntry> adopted;
+        for (const std::string &name : list_directory(dataDir)) {
+            if (listed.count(name) || export_kind(name).empty()) continue;
+            std::string path = dataDir + "/" + name;
+            struct stat st;
+            if (stat(path.c_str(), &st) != 0) continue;
+            ExportManifestEntry e;
+            e.time = (int64_t)st.st_mtime;
+            e.size = (uint64_t)st.st_size;
+            e.name = name;
+            e.object = "-";
+            std::string bytes;
+            if (e.size <= kExportAdoptMaxBytes && read_whole_file(path, bytes) && !export_store_object(path, bytes, e.object)) continue;
+            adopted.push_back(e);
+        }
+        entries.insert(entries.end(), adopted.begin(), adopted.end());
+
+        // Retention: per kind, newest first
+        std::unordered_map<std::string, bool> dropped;
+        if (keepDays > 0) {
+            int64_t cutoff = (int64_t)time(nullptr) - (int64_t)keepDays * 86400;
+            std::unordered_map<std::string, std::vector<size_t>> kinds;
+            for (size_t i = 0; i < entries.size(); ++i) kinds[export_kind(entries[i].name)].push_back(i);
+            for (auto &kv : kinds) {
+                std::vector<size_t> &idx = kv.second;
+                std::sort(idx.begin(), idx.end(), [&](size_t a, size_t b) { return entries[a].time > entries[b].time; });
+                for (size_t r = (size_t)keepLast; r < idx.size(); ++r) {
+                    if (entries[idx[r]].time >= cutoff) continue;
+                    std::remove((dataDir + "/" + entries[idx[r]].name).c_str());
+                    dropped[entries[idx[r]].name] = true;
+                }
+            }
+        }
 
-    for (const auto &d : dailyLogs) {
-        if (d.ts < cutoff) continue;
-        human_section << human_log_line(d.type.c_str(), d.text, d.ts) << "\n";
-        if (d.type == "HOURLY") {
-            std::string iso = format_iso_time(d.ts);
-            std::string js = std::string("{\"type\":\"HOURLY\",\"timestamp\":\"") + json_escape(iso) + "\",\"text\":\"" + json_escape(d.text) + "\"}";
-            hourly_jsonl_section << js << "\n";
+        // Merge into the manifest as it is now: exports may have been appended meanwhile
+        std::lock_guard<std::mutex> lock(exportStoreMutex);
+        std::unordered_map<std::string, bool> referenced;
+        std::string manifest;
+        for (const auto &e : export_manifest_read()) {
+            if (dropped.count(e.name)) continue;
+            manifest += format_manifest_line(e);
+            if (e.object != "-") referenced[e.object] = true;
+        }
+        for (const auto &e : adopted) {
+            if (dropped.count(e.name)) continue;
+            manifest += format_manifest_line(e);
+            if (e.object != "-") referenced[e.object] = true;
         }
+        if (!adopted.empty() || !dropped.empty()) write_file_atomic(path_in_data(EXPORT_MANIFEST_FILE), manifest);
+
+        // Objects no name refers to any more, and leftovers of interrupted writes. An
+        // object that is still hard-linked outside the manifest is left alone, and so is
+        // a recent temporary file (another process may be writing it).
+        size_t objectsRemoved = 0;
+        time_t now = time(nullptr);
+        for (const std::string &obj : list_directory(objDir)) {
+            if (referenced.count(obj)) continue;
+            std::string path = objDir + "/" + obj;
+            struct stat st;
+            if (stat(path.c_str(), &st) != 0 || st.st_nlink > 1) continue;
+            if (obj.find(".tmp") != std::string::npos && now - st.st_mtime < 3600) continue;
+            std::remove(path.c_str());
+            ++objectsRemoved;
+        }
+
+        if (!adopted.empty() || !dropped.empty() || objectsRemoved)
+            fprintf(stderr, "exports: %zu adopted, %zu removed by retention, %zu unused objects deleted\n",
+                    adopted.size(), dropped.size(), objectsRemoved);
+    }, JobPriority::Low);
+}
+
+// ----------------------- Aggregate store ----------------------------------
+// Per-day, per-hour counters updated as records are applied, so statistics and
+// exports never rescan dailyLogs/breaks. Persisted to aggregates.bin together with
+// every snapshot (tagged with the same sequence number).
+//
+// File: "PTAGG01\n" | u64 seq | u32 days | { i32 day | u32 hour_mask | hours... }* | u32 crc32
+// Only hours with a bit set in hour_mask are stored.
+static const int kBreakTypeSlots = 7; // one per kBreakTypes entry, last slot for any other type
+static const char* AGGREGATES_FILE_NAME = "aggregates.bin";
+static const char AGGREGATES_MAGIC[8] = {'P','T','A','G','G','0','1','\n'};
+
+struct HourBucket {
+    uint32_t tracked_seconds = 0;
+    uint32_t break_seconds[kBreakTypeSlots] = {};
+    uint32_t hourly_entries = 0;
+    uint32_t tasks_completed = 0;
+    bool empty() const {
+        if (tracked_seconds || hourly_entries || tasks_completed) return false;
+        for (uint32_t s : break_seconds) if (s) return false;
+        return true;
     }
+};
+struct DayAggregate {
+    int32_t day = 0; // local calendar day, days since 1970-01-01
+    HourBucket hours[24];
+};
 
-    std::ostringstream final_content;
-    final_content << human_section.str();
-    final_content << "\n=== HOURLY_ENTRIES_JSONL (one JSON object per line) ===\n";
-    final_content << hourly_jsonl_section.str();
-    final_content << "\n=== END OF EXPORT ===\n";
+static std::vector<DayAggregate> dayAggregates; // sorted by day
+static uint64_t agg_version = 0;                // bumped on every change (cache invalidation)
 
-    std::string path = export_text_to_file("weekly_logs_export", final_content.str().c_str());
-    return path;
+static int break_type_slot(const std::string &type) {
+    for (int i = 0; i < (int)kBreakTypes.size() && i < kBreakTypeSlots - 1; ++i)
+        if (kBreakTypes[i] == type) return i;
+    return kBreakTypeSlots - 1;
 }
-
-// ----------------------- Persistence & data --------------------------------
-static void append_daily_log(const char* type, const std::string &text) {
-    DailyLog d{ time(nullptr), type, text };
-    dailyLogs.push_back(d);
-    append_line_to_file(path_in_data("daily_logs.txt"), human_log_line(type, text, d.ts));
+static int32_t days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
 }
-static void save_tasks() {
-    std::string p = path_in_data("tasks.txt");
-    std::ofstream f(p);
-    if (!f) return;
-    for (size_t i = 0; i < tasks.size(); ++i) {
-        f << i << ": [" << (tasks[i].done ? "x" : " ") << "] " << tasks[i].name;
-        if (tasks[i].parent != -1) f << " (parent=" << tasks[i].parent << ")";
-        f << "\n";
-    }
+static int32_t local_day_index(time_t t, int* hour = nullptr) {
+    struct tm tm{};
+#if defined(_WIN32)
+    localtime_s(&tm, &t);
+#else
+    localtime_r(&t, &tm);
+#endif
+    if (hour) *hour = tm.tm_hour;
+    return days_from_civil(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
 }
-static void save_daily_status_to_disk_and_log(const std::string &text) {
-    append_line_to_file(path_in_data("daily_status.txt"), human_log_line("DAILY_STATUS", text));
-    append_daily_log("DAILY_STATUS", text);
-    std::string p = export_text_to_file("daily_status_saved", text.c_str());
-    if (!p.empty()) append_daily_log("EXPORT", std::string("Exported daily status to ") + p);
+static DayAggregate* agg_find_day(int32_t day) {
+    auto it = std::lower_bound(dayAggregates.begin(), dayAggregates.end(), day,
+                               [](const DayAggregate &a, int32_t d) { return a.day < d; });
+    return (it != dayAggregates.end() && it->day == day) ? &*it : nullptr;
 }
-static void save_weekly_status_to_disk_and_log(const std::string &text) {
-    append_line_to_file(path_in_data("weekly_status.txt"), human_log_line("WEEKLY_STATUS", text));
-    append_daily_log("WEEKLY_STATUS", text);
-    std::string p = export_text_to_file("weekly_status_saved", text.c_str());
-    if (!p.empty()) append_daily_log("EXPORT", std::string("Exported weekly status to ") + p);
+static HourBucket& agg_bucket(time_t t) {
+    int hour = 0;
+    int32_t day = local_day_index(t, &hour);
+    if (dayAggregates.empty() || dayAggregates.back().day < day) {
+        dayAggregates.emplace_back();
+        dayAggregates.back().day = day;
+        return dayAggregates.back().hours[hour];
+    }
+    auto it = std::lower_bound(dayAggregates.begin(), dayAggregates.end(), day,
+                               [](const DayAggregate &a, int32_t d) { return a.day < d; });
+    if (it == dayAggregates.end() || it->day != day) {
+        it = dayAggregates.insert(it, DayAggregate());
+        it->day = day;
+    }
+    return it->hours[hour];
 }
-static void load_tasks() {
-    tasks.clear();
-    std::ifstream f(path_in_data("tasks.txt"));
-    if (!f) return;
-    std::string line;
-    while (std::getline(f, line)) {
-        if (line.empty()) continue;
-        size_t colon = line.find(':');
-        std::string rest = (colon == std::string::npos) ? line : line.substr(colon + 1);
-        size_t pos = rest.find_first_not_of(" \t");
-        if (pos != std::string::npos) rest = rest.substr(pos);
-        bool done = false;
-        if (rest.size() >= 3 && rest[0] == '[' && rest[2] == ']') {
-            done = (rest[1] == 'x' || rest[1] == 'X');
-            size_t br = rest.find(']');
-            if (br != std::string::npos) rest = rest.substr(br + 1);
-            pos = rest.find_first_not_of(" \t");
-            if (pos != std::string::npos) rest = rest.substr(pos);
-        }
-        int parent = -1;
-        size_t ppos = rest.rfind("(parent=");
-        if (ppos != std::string::npos) {
-            size_t endp = rest.find(')', ppos);
-            if (endp != std::string::npos) {
-                std::string num = rest.substr(ppos + 8, endp - (ppos + 8));
-                try { parent = std::stoi(num); } catch(...) { parent = -1; }
-                rest = rest.substr(0, ppos);
-                while (!rest.empty() && isspace((unsigned char)rest.back())) rest.pop_back();
-            }
-        }
-        Task t; t.name = rest; t.parent = parent; t.done = done;
-        tasks.push_back(t);
+
+// Spreads [from, to) over the hour buckets it covers. slot < 0 means tracked time.
+static void agg_add_interval(time_t from, time_t to, int slot) {
+    if (from <= 0 || to <= from) return;
+    time_t t = from;
+    while (t < to) {
+        struct tm tm{};
+#if defined(_WIN32)
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        time_t hourEnd = t + (3600 - (tm.tm_min * 60 + tm.tm_sec));
+        if (hourEnd > to) hourEnd = to;
+        HourBucket &b = agg_bucket(t);
+        uint32_t secs = (uint32_t)(hourEnd - t);
+        if (slot < 0) b.tracked_seconds += secs;
+        else b.break_seconds[slot] += secs;
+        t = hourEnd;
     }
+    ++agg_version;
 }
-static void load_daily_logs() {
-    dailyLogs.clear();
-    std::ifstream f(path_in_data("daily_logs.txt"));
-    if (!f) return;
-    std::string line;
-    while (std::getline(f, line)) {
-        if (line.empty()) continue;
-        size_t firstDash = line.find(" - ");
-        if (firstDash != std::string::npos) {
-            size_t secondDash = line.find(" - ", firstDash + 3);
-            DailyLog d;
-            if (secondDash != std::string::npos) {
-                std::string ts = line.substr(0, firstDash);
-                d.ts = parse_timestamp(ts);
-                d.type = line.substr(firstDash + 3, secondDash - (firstDash + 3));
-                size_t restStart = secondDash + 3;
-                d.text = (restStart < line.size()) ? line.substr(restStart) : std::string();
-            } else {
-                std::string ts = line.substr(0, firstDash);
-                d.ts = parse_timestamp(ts);
-                d.type = "LOG";
-                d.text = line.substr(firstDash + 3);
-            }
-            dailyLogs.push_back(d);
-        } else {
-            DailyLog d; d.ts = time(nullptr); d.type = "LOG"; d.text = line;
-            dailyLogs.push_back(d);
+static void agg_count_hourly_entry(time_t t) { ++agg_bucket(t).hourly_entries; ++agg_version; }
+static void agg_count_task_completed(time_t t) { ++agg_bucket(t).tasks_completed; ++agg_version; }
+static void agg_clear() { dayAggregates.clear(); ++agg_version; }
+
+struct AggregateTotals {
+    uint64_t tracked_seconds = 0;
+    uint64_t break_seconds[kBreakTypeSlots] = {};
+    uint32_t hourly_entries = 0;
+    uint32_t tasks_completed = 0;
+    uint64_t total_break_seconds() const { uint64_t s = 0; for (uint64_t v : break_seconds) s += v; return s; }
+};
+// Sums the inclusive day range [firstDay, lastDay]; cost is O(days in range).
+static AggregateTotals agg_totals(int32_t firstDay, int32_t lastDay) {
+    AggregateTotals out;
+    auto it = std::lower_bound(dayAggregates.begin(), dayAggregates.end(), firstDay,
+                               [](const DayAggregate &a, int32_t d) { return a.day < d; });
+    for (; it != dayAggregates.end() && it->day <= lastDay; ++it) {
+        for (const HourBucket &h : it->hours) {
+            out.tracked_seconds += h.tracked_seconds;
+            for (int s = 0; s < kBreakTypeSlots; ++s) out.break_seconds[s] += h.break_seconds[s];
+            out.hourly_entries += h.hourly_entries;
+            out.tasks_completed += h.tasks_completed;
         }
     }
+    return out;
 }
 
-// ---------------- Breaks/tasks helper definitions -------------------------
-static void start_break(const std::string &type) {
-    bool was_active = (active_breaks_count() > 0);
-
-    BreakEntry b; b.type = type; b.start = time(nullptr); b.end = 0;
-    breaks.push_back(b);
-    append_daily_log("BREAK_START", std::string("Started break: ") + type);
-
-    // If this is the first active break, pause the session tracking
-    if (!was_active) {
-        if (tracking_start_time != 0) {
-            time_t now = time(nullptr);
-            accumulated_tracked_seconds += (long)(now - tracking_start_time);
-            tracking_start_time = 0;
-            append_daily_log("TIMER", std::string("Paused session timer (break started)"));
-        }
+// ----------------------- Log styles ---------------------------------------
+// How each log type is drawn (colour, optional icon prefix, bold). Rules are matched
+// against a type once, when the type is first seen; entries carry the resulting
+// style id, so drawing a row never looks at the type string.
+//
+// log_styles.txt in the data dir replaces the built-in rules, one rule per line:
+//   <TYPE or PREFIX*> <#RRGGBB> [bold] [icon=<text>]
+// The first matching rule wins; "*" matches everything. '#' starts a comment line.
+static const char* LOG_STYLES_FILE = "log_styles.txt";
+struct LogStyle {
+    ImU32 color;
+    bool bold;
+    char icon[8];
+};
+struct LogStyleRule {
+    std::string pattern; // exact type, or a prefix when it ends with '*'
+    uint8_t style;
+};
+static std::vector<LogStyle> logStyles;
+static std::vector<LogStyleRule> logStyleRules;
+static uint8_t logStyleFallback = 0;
+
+static const char* kDefaultLogStyles =
+    "HOURLY #66B3FF\n"
+    "DAILY_STATUS #FFE666\n"
+    "WEEKLY_STATUS #99FF99\n"
+    "BREAK* #FF9999\n"
+    "EXPORT #CC99FF\n"
+    "TASK #CCCCD9\n"
+    "* #E6E6E6\n";
+
+static bool parse_log_style_line(const std::string &line, std::string &pattern, LogStyle &st) {
+    std::istringstream in(line);
+    std::string color, opt;
+    if (!(in >> pattern >> color) || pattern[0] == '#') return false;
+    unsigned int rgb = 0;
+    if (color.size() != 7 || color[0] != '#' || sscanf(color.c_str() + 1, "%6x", &rgb) != 1) return false;
+    st.color = IM_COL32((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF, 0xFF);
+    st.bold = false;
+    st.icon[0] = '\0';
+    while (in >> opt) {
+        if (opt == "bold") st.bold = true;
+        else if (opt.rfind("icon=", 0) == 0) snprintf(st.icon, sizeof(st.icon), "%s", opt.c_str() + 5);
     }
+    return true;
 }
-static void end_last_break_of_type(const std::string &type) {
-    for (auto it = breaks.rbegin(); it != breaks.rend(); ++it) {
-        if (it->type == type && it->end == 0) {
-            it->end = time(nullptr);
-            std::ostringstream oss;
-            oss << "Ended break: " << it->type << " (start " << format_time_local(it->start)
-                << ", end " << format_time_local(it->end) << ")";
-            append_daily_log("BREAK_END", oss.str());
-
-            // If there are no more active breaks after ending this one, resume the session tracking
-            if (active_breaks_count() == 0) {
-                tracking_start_time = time(nullptr);
-                append_daily_log("TIMER", std::string("Resumed session timer (break ended)"));
-            }
-            return;
-        }
+static void load_log_style_rules(std::istream &in) {
+    logStyles.clear();
+    logStyleRules.clear();
+    std::string line, pattern;
+    while (std::getline(in, line) && logStyles.size() < 255) {
+        LogStyle st;
+        if (!parse_log_style_line(line, pattern, st)) continue;
+        logStyleRules.push_back(LogStyleRule{ pattern, (uint8_t)logStyles.size() });
+        logStyles.push_back(st);
     }
-    append_daily_log("BREAK_WARN", std::string("Tried to end break but none active: ") + type);
+    // rows without a matching rule use the last "*" rule, or plain text colour
+    logStyleFallback = (uint8_t)logStyles.size();
+    for (const auto &r : logStyleRules) if (r.pattern == "*") { logStyleFallback = r.style; break; }
+    if (logStyleFallback == logStyles.size()) logStyles.push_back(LogStyle{ IM_COL32(230, 230, 230, 255), false, "" });
 }
-static void add_random_break() {
-    std::uniform_int_distribution<int> dtype(0, (int)kBreakTypes.size()-1);
-    std::uniform_int_distribution<int> dmin(1, 20);
-    std::string t = kBreakTypes[dtype(rng)];
-    BreakEntry b; b.type = t; b.start = time(nullptr) - dmin(rng)*60; b.end = time(nullptr);
-    breaks.push_back(b);
-    std::ostringstream oss; oss << "Random break: " << b.type << " (" << format_time_local(b.start) << " - " << format_time_local(b.end) << ")";
-    append_daily_log("BREAK_RANDOM", oss.str());
+// Reads log_styles.txt, falling back to the built-in rules. Call before logs are indexed.
+static void load_log_styles() {
+    std::ifstream f(path_in_data(LOG_STYLES_FILE));
+    if (f) {
+        load_log_style_rules(f);
+        if (!logStyleRules.empty()) return;
+        fprintf(stderr, "%s has no valid rules, using defaults\n", LOG_STYLES_FILE);
+    }
+    std::istringstream defaults(kDefaultLogStyles);
+    load_log_style_rules(defaults);
 }
-static void add_task(const std::string &name, int parent_idx) {
-    Task tt; tt.name = name; tt.parent = parent_idx; tt.done = false;
-    tasks.push_back(tt);
-    save_tasks();
-    append_daily_log("TASK", std::string("Added task: ") + name);
+static uint8_t resolve_log_style(const std::string &type) {
+    for (const auto &r : logStyleRules) {
+        const std::string &p = r.pattern;
+        if (p.back() == '*' ? type.compare(0, p.size() - 1, p, 0, p.size() - 1) == 0 : type == p) return r.style;
+    }
+    return logStyleFallback;
 }
 
-static void clearAllData()
-{
-    // Clear in-memory structures
-    dailyLogs.clear();
-    breaks.clear();
-    tasks.clear();
+// ----------------------- Day index ----------------------------------------
+// Runs of consecutive dailyLogs entries that fall on the same local day. Logs are
+// appended in time order, so there is roughly one run per day; dayRunsByDay lists
+// each day's runs, so a day-range query touches O(days) runs instead of every log entry.
+struct DayRun {
+    int32_t day;
+    uint32_t first; // index into dailyLogs
+    uint32_t last;  // one past the end
+};
+static std::vector<DayRun> dayIndex;
+static std::map<int32_t, std::vector<uint32_t>> dayRunsByDay; // day -> its runs (ascending indices into dayIndex)
+
+// Per-type facets kept alongside: the (ascending) log indices of each log type, so
+// type counts are list sizes and a type filter is a merge of a few lists.
+struct LogTypeFacet {
+    std::string type;
+    uint8_t style;              // resolved once per type, copied into each entry
+    std::vector<uint32_t> logs;
+};
+static std::vector<LogTypeFacet> logTypeFacets;
+static std::unordered_map<std::string, uint32_t> logTypeFacetIds;
+static uint64_t dayIndexGeneration = 0; // bumped whenever the index is rebuilt from scratch
+
+static void day_index_append(size_t logIdx) {
+    DailyLog &d = dailyLogs[logIdx];
+    auto it = logTypeFacetIds.find(d.type);
+    if (it == logTypeFacetIds.end()) {
+        it = logTypeFacetIds.emplace(d.type, (uint32_t)logTypeFacets.size()).first;
+        logTypeFacets.push_back(LogTypeFacet{ d.type, resolve_log_style(d.type), {} });
+    }
+    LogTypeFacet &facet = logTypeFacets[it->second];
+    facet.logs.push_back((uint32_t)logIdx);
+    d.style = facet.style;
 
-    // Reset timers
-    app_start_time = time(nullptr);
-    tracking_start_time = app_start_time;
-    accumulated_tracked_seconds = 0;
+    int32_t day = local_day_index(d.ts);
+    if (!dayIndex.empty() && dayIndex.back().day == day && dayIndex.back().last == (uint32_t)logIdx) {
+        dayIndex.back().last = (uint32_t)logIdx + 1;
+        return;
+    }
+    dayRunsByDay[day].push_back((uint32_t)dayIndex.size());
+    dayIndex.push_back(DayRun{ day, (uint32_t)logIdx, (uint32_t)logIdx + 1 });
+}
+static void rebuild_day_index() {
+    dayIndex.clear();
+    dayRunsByDay.clear();
+    logTypeFacets.clear();
+    logTypeFacetIds.clear();
+    ++dayIndexGeneration;
+    for (size_t i = 0; i < dailyLogs.size(); ++i) day_index_append(i);
+}
+// Re-reads the style table and restamps every entry (View > Reload log styles).
+static void reload_log_styles() {
+    load_log_styles();
+    for (auto &facet : logTypeFacets) {
+        facet.style = resolve_log_style(facet.type);
+        for (uint32_t i : facet.logs) dailyLogs[i].style = facet.style;
+    }
+}
+// Calls fn(const DayRun&) for the runs of the days in [firstDay, lastDay], in log order.
+template <typename Fn>
+static void for_each_run_in_days(int32_t firstDay, int32_t lastDay, Fn fn) {
+    std::vector<uint32_t> runs;
+    for (auto it = dayRunsByDay.lower_bound(firstDay); it != dayRunsByDay.end() && it->first <= lastDay; ++it)
+        runs.insert(runs.end(), it->second.begin(), it->second.end());
+    std::sort(runs.begin(), runs.end()); // days are usually in order already; a back-dated import is not
+    for (uint32_t r : runs) fn(dayIndex[r]);
+}
+// Calls fn(const DailyLog&) for every entry whose local day is in [firstDay, lastDay], in log order.
+template <typename Fn>
+static void for_each_log_in_days(int32_t firstDay, int32_t lastDay, Fn fn) {
+    for_each_run_in_days(firstDay, lastDay, [&](const DayRun &run) {
+        for (uint32_t i = run.first; i < run.last; ++i) fn(dailyLogs[i]);
+    });
 }
 
-static std::atomic<bool> request_quit(false);
+// ----------------------- Log view filter ----------------------------------
+// The Daily Logs panel shows dailyLogs filtered by type and date range. The visible
+// indices are cached in logView.rows and only recomputed when a filter changes or the
+// day index is rebuilt; appended logs are tested and added on their own.
+enum LogDateRange { LogRangeAll = 0, LogRangeToday, LogRangeWeek, LogRangeMonth, LogRangeCustom };
+struct LogViewFilter {
+    int range = LogRangeAll;
+    char customFrom[16] = "";            // YYYY-MM-DD, empty = open
+    char customTo[16] = "";
+    std::vector<std::string> hiddenTypes; // types unchecked in the Types popup
+};
+struct LogView {
+    bool all = true;                 // no filter active: rows is unused, show dailyLogs as-is
+    std::vector<uint32_t> rows;      // ascending log indices
+    std::vector<uint32_t> inRange;   // per facet id: logs of that type inside the date range
+    int32_t firstDay = 0, lastDay = 0;
+    int32_t today = 0;               // relative ranges move at midnight
+    size_t logCount = 0;
+    uint64_t generation = (uint64_t)-1;
+    bool dirty = true;
+};
+static LogViewFilter logFilter;
+static LogView logView;
 
-static void end_day_action() {
-    time_t now = time(nullptr);
-    // End any active breaks
-    for (auto &b : breaks) {
-        if (b.end == 0) {
-            b.end = now;
-            std::ostringstream oss; oss << "Ended break: " << b.type << " (start " << format_time_local(b.start) << ", end " << format_time_local(b.end) << ")";
-            append_daily_log("BREAK_END", oss.str());
-        }
+static bool log_type_hidden(const std::string &type) {
+    return std::find(logFilter.hiddenTypes.begin(), logFilter.hiddenTypes.end(), type) != logFilter.hiddenTypes.end();
+}
+static int32_t parse_day(const char* s, int32_t fallback) {
+    int y, m, d;
+    if (sscanf(s, "%4d-%2d-%2d", &y, &m, &d) == 3 && m >= 1 && m <= 12 && d >= 1 && d <= 31) return days_from_civil(y, m, d);
+    return fallback;
+}
+static void log_view_day_range(int32_t &firstDay, int32_t &lastDay) {
+    int32_t today = local_day_index(time(nullptr));
+    firstDay = INT32_MIN;
+    lastDay = INT32_MAX;
+    switch (logFilter.range) {
+    case LogRangeToday: firstDay = lastDay = today; break;
+    case LogRangeWeek: firstDay = today - 6; lastDay = today; break;
+    case LogRangeMonth: firstDay = today - 29; lastDay = today; break;
+    case LogRangeCustom:
+        firstDay = parse_day(logFilter.customFrom, INT32_MIN);
+        lastDay = parse_day(logFilter.customTo, INT32_MAX);
+        break;
+    default: break;
     }
+}
 
-    // Pause tracking if running and accumulate
-    if (tracking_start_time != 0) {
-        accumulated_tracked_seconds += (long)(now - tracking_start_time);
-        tracking_start_time = 0;
-        append_daily_log("TIMER", std::string("Paused session timer (end of day)"));
+// One pass over the day runs in range: each selected type's indices inside the run are
+// located by binary search and merged, which also yields the per-type counts.
+static void recompute_log_view() {
+    logView.dirty = false;
+    logView.generation = dayIndexGeneration;
+    logView.logCount = dailyLogs.size();
+    logView.today = local_day_index(time(nullptr));
+    log_view_day_range(logView.firstDay, logView.lastDay);
+    logView.rows.clear();
+    logView.inRange.assign(logTypeFacets.size(), 0);
+    std::vector<bool> selected(logTypeFacets.size());
+    bool anyHidden = false;
+    for (size_t t = 0; t < logTypeFacets.size(); ++t) {
+        selected[t] = !log_type_hidden(logTypeFacets[t].type);
+        anyHidden |= !selected[t];
     }
+    const bool allDays = logView.firstDay == INT32_MIN && logView.lastDay == INT32_MAX;
+    logView.all = allDays && !anyHidden;
+    if (allDays) {
+        for (size_t t = 0; t < logTypeFacets.size(); ++t) logView.inRange[t] = (uint32_t)logTypeFacets[t].logs.size();
+        if (logView.all) return;
+        // only a type filter: a single sweep that skips the hidden types' logs
+        std::vector<bool> hidden(dailyLogs.size());
+        for (size_t t = 0; t < logTypeFacets.size(); ++t)
+            if (!selected[t]) for (uint32_t i : logTypeFacets[t].logs) hidden[i] = true;
+        for (uint32_t i = 0; i < (uint32_t)dailyLogs.size(); ++i) if (!hidden[i]) logView.rows.push_back(i);
+        return;
+    }
+    for_each_run_in_days(logView.firstDay, logView.lastDay, [&](const DayRun &run) {
+        size_t before = logView.rows.size();
+        int slices = 0;
+        for (size_t t = 0; t < logTypeFacets.size(); ++t) {
+            const auto &v = logTypeFacets[t].logs;
+            auto lo = std::lower_bound(v.begin(), v.end(), run.first);
+            auto hi = std::lower_bound(lo, v.end(), run.last);
+            logView.inRange[t] += (uint32_t)(hi - lo);
+            if (!selected[t] || lo == hi) continue;
+            size_t mid = logView.rows.size();
+            logView.rows.insert(logView.rows.end(), lo, hi);
+            if (slices++ > 0) std::inplace_merge(logView.rows.begin() + before, logView.rows.begin() + mid, logView.rows.end());
+        }
+    });
+}
 
-    long total_tracked = accumulated_tracked_seconds;
-    std::string total_s = format_duration_seconds(total_tracked);
-    append_daily_log("END_DAY", std::string("End of day. Total tracked: ") + total_s);
-
-    // Export hourly logs (today)
-    std::string p1 = export_hourly_logs_today();
-    if (!p1.empty()) append_daily_log("EXPORT", std::string("Exported hourly logs (today) to ") + p1);
+// Brings the cached view up to date; cheap when nothing changed.
+static void update_log_view() {
+    bool relative = logFilter.range == LogRangeToday || logFilter.range == LogRangeWeek || logFilter.range == LogRangeMonth;
+    if (logView.dirty || logView.generation != dayIndexGeneration || logView.logCount > dailyLogs.size() ||
+        (relative && logView.today != local_day_index(time(nullptr)))) {
+        recompute_log_view();
+        return;
+    }
+    for (size_t i = logView.logCount; i < dailyLogs.size(); ++i) {
+        const DailyLog &d = dailyLogs[i];
+        auto it = logTypeFacetIds.find(d.type);
+        if (it != logTypeFacetIds.end()) {
+            if (logView.inRange.size() <= it->second) logView.inRange.resize(it->second + 1, 0);
+            int32_t day = local_day_index(d.ts);
+            if (day < logView.firstDay || day > logView.lastDay) continue;
+            ++logView.inRange[it->second];
+        }
+        if (!logView.all && !log_type_hidden(d.type)) logView.rows.push_back((uint32_t)i);
+    }
+    logView.logCount = dailyLogs.size();
+}
 
-    // Export weekly logs
-    std::string p2 = export_weekly_logs_file();
-    if (!p2.empty()) append_daily_log("EXPORT", std::string("Exported weekly logs to ") + p2);
+// ----------------------- Exports: hourly/weekly ---------------------------
+// Exports copy the entries they need on the UI thread (via the day index), then format
+// and write the file as a Low-priority pool job. The EXPORT log line is added on
+// completion, back on the UI thread.
+static void export_hourly_logs_today() {
+    if (instance_is_secondary()) return;
+    time_t now = time(nullptr);
+    int32_t today = local_day_index(now);
+    std::vector<DailyLog> entries;
+    for_each_log_in_days(today, today, [&](const DailyLog &d) { if (d.type == "HOURLY") entries.push_back(d); });
+    if (entries.empty()) return;
+    jobPool.submit([entries = std::move(entries)]() {
+        std::ostringstream content;
+        for (const auto &d : entries) content << human_log_line(d.type.c_str(), d.text, d.ts) << "\n";
+        std::string p = export_text_to_file("hourly_logs_today", content.str().c_str());
+        if (!p.empty()) post_to_ui([p] { append_daily_log("EXPORT", std::string("Exported hourly logs (today) to ") + p); });
+    }, JobPriority::Low);
+}
+// Columnar weekly export (weekly_logs_export_*.ptcol) for analytics jobs that would
+// otherwise re-parse the text export. Little-endian, every section 8-byte aligned so
+// columns can be mmapped and scanned in place (numpy.frombuffer etc.):
+//   header   "PTCOL1\0\0" | u32 version=1 | u32 section_count | u64 rows |
+//            i64 first_ts | i64 last_ts | u32 crc32(bytes after the section table) | u32 0
+//   section  char name[12] | u32 encoding | u64 offset | u64 size        (32 bytes each)
+//   "ts"        delta_i64  i64[rows]: unix seconds, first value absolute, then differences
+//   "type"      i32        i32[rows]: index into the type dictionary
+//   "type_off"  u64        u64[types+1]: type i is type_str[type_off[i], type_off[i+1])
+//   "type_str"  bytes      UTF-8 type names
+//   "text_off"  u64        u64[rows+1]: row i is text_str[text_off[i], text_off[i+1])
+//   "text_str"  bytes      UTF-8 log text
+enum ColumnEncoding : uint32_t { ColDeltaI64 = 1, ColI32 = 2, ColU64 = 3, ColBytes = 4 };
+struct ColumnarExport {
+    std::string ts, type, textOff, text;   // column bytes, filled row by row
+    std::vector<int32_t> dictOfFacet;      // facet id -> dictionary id, -1 until used
+    std::vector<std::string> dict;
+    uint64_t rows = 0;
+    int64_t firstTs = 0, lastTs = 0;
+};
+static void columnar_begin(ColumnarExport &c) {
+    c.dictOfFacet.assign(logTypeFacets.size(), -1);
+    put_u64(c.textOff, 0);
+}
+static void columnar_add(ColumnarExport &c, const DailyLog &d) {
+    int32_t id = -1;
+    auto it = logTypeFacetIds.find(d.type);
+    if (it != logTypeFacetIds.end()) {
+        int32_t &slot = c.dictOfFacet[it->second];
+        if (slot < 0) { slot = (int32_t)c.dict.size(); c.dict.push_back(d.type); }
+        id = slot;
+    }
+    put_u64(c.ts, (uint64_t)((int64_t)d.ts - (c.rows ? c.lastTs : 0)));
+    put_u32(c.type, (uint32_t)id);
+    c.text += d.text;
+    put_u64(c.textOff, c.text.size());
+    if (c.rows++ == 0) c.firstTs = (int64_t)d.ts;
+    c.lastTs = (int64_t)d.ts;
+}
+static std::string columnar_finish(const ColumnarExport &c) {
+    std::string typeOff, typeStr;
+    put_u64(typeOff, 0);
+    for (const auto &t : c.dict) { typeStr += t; put_u64(typeOff, typeStr.size()); }
+    struct Section { const char* name; uint32_t enc; const std::string* data; };
+    const Section sections[] = {
+        { "ts", ColDeltaI64, &c.ts }, { "type", ColI32, &c.type },
+        { "type_off", ColU64, &typeOff }, { "type_str", ColBytes, &typeStr },
+        { "text_off", ColU64, &c.textOff }, { "text_str", ColBytes, &c.text },
+    };
+    const uint32_t count = (uint32_t)(sizeof(sections) / sizeof(sections[0]));
+    std::string body, table;
+    const uint64_t dataStart = 48 + 32 * (uint64_t)count;
+    for (const Section &sec : sections) {
+        char name[12] = {};
+        std::strncpy(name, sec.name, sizeof(name));
+        table.append(name, sizeof(name));
+        put_u32(table, sec.enc);
+        put_u64(table, dataStart + body.size());
+        put_u64(table, sec.data->size());
+        body += *sec.data;
+        body.append((8 - body.size() % 8) % 8, '\0');
+    }
+    std::string out("PTCOL1\0\0", 8);
+    put_u32(out, 1);
+    put_u32(out, count);
+    put_u64(out, c.rows);
+    put_u64(out, (uint64_t)c.firstTs);
+    put_u64(out, (uint64_t)c.lastTs);
+    put_u32(out, crc32_update(0, (const unsigned char*)body.data(), body.size()));
+    put_u32(out, 0);
+    out += table;
+    out += body;
+    return out;
+}
 
-    // Save inline daily/weekly status if present
-    if (std::strlen(dailyStatusText) > 0) {
-        std::string pd = export_text_to_file("daily_status_end_of_day", dailyStatusText);
-        if (!pd.empty()) append_daily_log("EXPORT", std::string("Exported daily status to ") + pd);
+static std::string json_escape(const std::string &s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        switch (c) {
+        case '\\': out += "\\\\"; break;
+        case '\"': out += "\\\""; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default: out += c; break;
+        }
     }
-    if (std::strlen(weeklyStatusText) > 0) {
-        std::string pw = export_text_to_file("weekly_status_end_of_day", weeklyStatusText);
-        if (!pw.empty()) append_daily_log("EXPORT", std::string("Exported weekly status to ") + pw);
+    return out;
+}
+static std::string weekly_export_header(time_t now, const AggregateTotals &tot) {
+    std::ostringstream human_section;
+    human_section << "WEEKLY LOG EXPORT\n";
+    human_section << "Generated: " << format_time_local(now) << "\n";
+    human_section << "Range: last 7 calendar days (today and the 6 before it)\n";
+
+    // Summary straight from the aggregate store (no history scan)
+    human_section << "Tracked: " << format_duration_seconds((time_t)tot.tracked_seconds)
+                  << " | Breaks: " << format_duration_seconds((time_t)tot.total_break_seconds());
+    for (int i = 0; i < kBreakTypeSlots; ++i) {
+        if (!tot.break_seconds[i]) continue;
+        human_section << " | " << (i < (int)kBreakTypes.size() ? kBreakTypes[i].c_str() : "Other")
+                      << ": " << format_duration_seconds((time_t)tot.break_seconds[i]);
+    }
+    human_section << " | Hourly entries: " << tot.hourly_entries
+                  << " | Tasks completed: " << tot.tasks_completed << "\n\n";
+    return human_section.str();
+}
+// Human lines of every entry, and a JSON object per line for the HOURLY ones.
+static void render_weekly_export_lines(const std::vector<DailyLog> &entries, std::string &human, std::string &jsonl) {
+    for (const auto &d : entries) {
+        human += human_log_line(d.type.c_str(), d.text, d.ts);
+        human += '\n';
+        if (d.type == "HOURLY") {
+            jsonl += "{\"type\":\"HOURLY\",\"timestamp\":\"" + json_escape(format_iso_time(d.ts)) + "\",\"text\":\"" + json_escape(d.text) + "\"}\n";
+        }
     }
+}
 
-    // Save tasks
-    save_tasks();
+// Export fragments. Most of a weekly export is days that are already over, so the
+// rendered lines of each such day (human lines, then its JSONL lines) are kept in
+// export_cache/slot<day % 8>.frag and later exports copy them instead of formatting
+// those entries again; the UI thread then only copies entries of the other days.
+// A fragment is used while its key still matches the day, which must be a single
+// run in the day index: same first log, count, and first/last rendered line.
+// On Linux cached bytes are copied with copy_file_range (in the kernel, or a reflink).
+//   "PTFRAG1\n" | i32 day | u32 first | u32 count | u32 human_bytes | u64 hash | human | jsonl
+static const char* EXPORT_CACHE_DIR = "export_cache";
+static const int kExportCacheSlots = 8; // more than the 6 whole days in a window
+static const size_t kExportFragmentHeader = 32;
+static const char EXPORT_FRAGMENT_MAGIC[8] = {'P','T','F','R','A','G','1','\n'};
+
+struct ExportFragment {
+    int32_t day = 0;
+    uint32_t first = 0;
+    uint32_t count = 0;
+    uint64_t hash = 0;
+    uint32_t humanBytes = 0;
+    uint64_t jsonlBytes = 0;
+    bool valid = false;
+    bool same_key(const ExportFragment &o) const { return day == o.day && first == o.first && count == o.count && hash == o.hash; }
+};
+static ExportFragment exportFragments[kExportCacheSlots]; // UI thread's view of the slot files
 
-    // Reset timers for next day/session
-    app_start_time = time(nullptr);
-    tracking_start_time = app_start_time;
-    accumulated_tracked_seconds = 0;
+static int export_fragment_slot(int32_t day) { return ((day % kExportCacheSlots) + kExportCacheSlots) % kExportCacheSlots; }
+static std::string export_fragment_path(int slot) {
+    std::string dir = path_in_data(EXPORT_CACHE_DIR);
+    ensure_dir_exists(dir);
+    return dir + "/slot" + std::to_string(slot) + ".frag";
+}
+static ExportFragment export_fragment_key(const DayRun &run) {
+    ExportFragment f;
+    f.day = run.day;
+    f.first = run.first;
+    f.count = run.last - run.first;
+    const DailyLog &a = dailyLogs[run.first], &b = dailyLogs[run.last - 1];
+    f.hash = fnv1a(human_log_line(b.type.c_str(), b.text, b.ts), fnv1a(human_log_line(a.type.c_str(), a.text, a.ts), 1469598103934665603ull));
+    return f;
+}
+// Reads and checks a fragment's header (from any stream position).
+static bool read_export_fragment_header(FILE* f, ExportFragment &out) {
+    std::string h(kExportFragmentHeader, '\0');
+    if (fseek(f, 0, SEEK_END) != 0) return false;
+    long size = ftell(f);
+    if (size < (long)kExportFragmentHeader || fseek(f, 0, SEEK_SET) != 0 || fread(&h[0], 1, h.size(), f) != h.size()) return false;
+    if (std::memcmp(h.data(), EXPORT_FRAGMENT_MAGIC, sizeof(EXPORT_FRAGMENT_MAGIC)) != 0) return false;
+    auto le = [&h](size_t off, int bytes) {
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) v |= (uint64_t)(unsigned char)h[off + i] << (8 * i);
+        return v;
+    };
+    out.day = (int32_t)(uint32_t)le(8, 4);
+    out.first = (uint32_t)le(12, 4);
+    out.count = (uint32_t)le(16, 4);
+    out.humanBytes = (uint32_t)le(20, 4);
+    out.hash = le(24, 8);
+    if ((uint64_t)size < kExportFragmentHeader + out.humanBytes) return false;
+    out.jsonlBytes = (uint64_t)size - kExportFragmentHeader - out.humanBytes;
+    out.valid = true;
+    return true;
+}
+static bool write_export_fragment(int slot, ExportFragment &f, const std::string &human, const std::string &jsonl) {
+    std::string b(EXPORT_FRAGMENT_MAGIC, sizeof(EXPORT_FRAGMENT_MAGIC));
+    put_u32(b, (uint32_t)f.day);
+    put_u32(b, f.first);
+    put_u32(b, f.count);
+    put_u32(b, (uint32_t)human.size());
+    put_u64(b, f.hash);
+    b += human;
+    b += jsonl;
+    f.humanBytes = (uint32_t)human.size();
+    f.jsonlBytes = jsonl.size();
+    f.valid = write_file_atomic(export_fragment_path(slot), b);
+    return f.valid;
+}
+// Startup: learn which fragments exist, so the first export can already skip their days.
+static void export_cache_load() {
+    jobPool.submit([]() {
+        auto found = std::make_shared<std::vector<std::pair<int, ExportFragment>>>();
+        for (int slot = 0; slot < kExportCacheSlots; ++slot) {
+            FILE* f = fopen(export_fragment_path(slot).c_str(), "rb");
+            if (!f) continue;
+            ExportFragment frag;
+            if (read_export_fragment_header(f, frag)) found->emplace_back(slot, frag);
+            fclose(f);
+        }
+        post_to_ui([found] {
+            for (const auto &sf : *found) if (!exportFragments[sf.first].valid) exportFragments[sf.first] = sf.second;
+        });
+    }, JobPriority::Low);
+}
 
-    // Request app quit after finishing end-of-day work
-    request_quit.store(true);
+// Appends src[off, off + len) to dst.
+static bool copy_file_bytes(FILE* src, uint64_t off, uint64_t len, FILE* dst) {
+#ifdef __linux__
+    if (fflush(dst) == 0) {
+        loff_t in = (loff_t)off;
+        while (len > 0) {
+            ssize_t n = copy_file_range(fileno(src), &in, fileno(dst), nullptr, (size_t)len, 0);
+            if (n <= 0) break; // e.g. EXDEV on older kernels: finish with the buffered copy
+            len -= (uint64_t)n;
+        }
+        off = (uint64_t)in;
+        fseek(dst, 0, SEEK_END); // the fd offset moved underneath the stream
+        if (len == 0) return true;
+    }
+#endif
+    if (fseek(src, (long)off, SEEK_SET) != 0) return false;
+    char buf[64 * 1024];
+    while (len > 0) {
+        size_t n = fread(buf, 1, (size_t)std::min<uint64_t>(len, sizeof(buf)), src);
+        if (n == 0 || fwrite(buf, 1, n, dst) != n) return false;
+        len -= n;
+    }
+    return true;
 }
 
-// Launch external analysis Python script (non-blocking)
-static void launch_analysis_script() {
-    // Try data dir first, then current dir
-    std::string path = path_in_data("analyze_productivity.py");
-    std::ifstream f(path);
-    if (!f) {
-        path = std::string("analyze_productivity.py");
-        f.open(path);
-    }
-    if (!f) {
-        append_daily_log("ANALYSIS", std::string("Could not find analyze_productivity.py in data dir or current working dir."));
-        return;
+// One day-index run of a weekly export: copied from a fragment, or rendered from
+// `entries` (and stored as a fragment when `store` is set).
+struct WeeklyExportPart {
+    ExportFragment frag;
+    bool cached = false;
+    bool store = false;
+    std::vector<DailyLog> entries;
+};
+
+// Job side of export_weekly_logs_file(): writes the text export, saving new fragments.
+static std::string write_weekly_export(std::vector<WeeklyExportPart> &parts, const std::string &header,
+                                       std::vector<ExportFragment> &stored) {
+    std::vector<FILE*> sources(parts.size(), nullptr);
+    std::vector<std::string> human(parts.size()), jsonl(parts.size());
+    bool ok = true;
+    for (size_t i = 0; i < parts.size() && ok; ++i) {
+        WeeklyExportPart &p = parts[i];
+        if (p.cached) {
+            // Held open from here on, so a concurrent export replacing the slot does not matter
+            ExportFragment onDisk;
+            sources[i] = fopen(export_fragment_path(export_fragment_slot(p.frag.day)).c_str(), "rb");
+            ok = sources[i] && read_export_fragment_header(sources[i], onDisk) && onDisk.same_key(p.frag);
+            p.frag = onDisk;
+            continue;
+        }
+        render_weekly_export_lines(p.entries, human[i], jsonl[i]);
+        if (p.store && write_export_fragment(export_fragment_slot(p.frag.day), p.frag, human[i], jsonl[i])) stored.push_back(p.frag);
+    }
+    std::string path;
+    FILE* out = ok ? fopen((path = export_file_path("weekly_logs_export", ".txt")).c_str(), "w") : nullptr;
+    if (out) {
+        ok = fwrite(header.data(), 1, header.size(), out) == header.size();
+        for (size_t i = 0; i < parts.size() && ok; ++i)
+            ok = sources[i] ? copy_file_bytes(sources[i], kExportFragmentHeader, parts[i].frag.humanBytes, out)
+                            : fwrite(human[i].data(), 1, human[i].size(), out) == human[i].size();
+        static const char marker[] = "\n=== HOURLY_ENTRIES_JSONL (one JSON object per line) ===\n";
+        ok = ok && fputs(marker, out) >= 0;
+        for (size_t i = 0; i < parts.size() && ok; ++i)
+            ok = sources[i] ? copy_file_bytes(sources[i], kExportFragmentHeader + parts[i].frag.humanBytes, parts[i].frag.jsonlBytes, out)
+                            : fwrite(jsonl[i].data(), 1, jsonl[i].size(), out) == jsonl[i].size();
+        ok = ok && fputs("\n=== END OF EXPORT ===\n\n", out) >= 0;
+        ok = (fclose(out) == 0) && ok;
+    }
+    for (FILE* f : sources) if (f) fclose(f);
+    if (!ok) {
+        fprintf(stderr, "weekly export failed%s\n", path.empty() ? " (export cache changed; export again)" : "");
+        if (!path.empty()) std::remove(path.c_str());
+        return std::string();
+    }
+    return path;
+}
+
+static void export_weekly_logs_file() {
+    if (dailyLogs.empty() || instance_is_secondary()) return; // the primary owns the export store and cache
+
+    // The entries and the header totals cover the same 7 calendar days
+    time_t now = time(nullptr);
+    int32_t today = local_day_index(now);
+    int32_t firstDay = today - 6;
+
+    // Days that are over may come from fragments, if the day is one run in the day index
+    auto runs_of_day = [](int32_t day) {
+        auto it = dayRunsByDay.find(day);
+        return it == dayRunsByDay.end() ? (size_t)0 : it->second.size();
+    };
+
+    // One pass over the day index fills the columns and, for runs without a usable
+    // fragment, the entries the job formats.
+    std::vector<WeeklyExportPart> parts;
+    ColumnarExport columns;
+    columnar_begin(columns);
+    for_each_run_in_days(firstDay, today, [&](const DayRun &run) {
+        WeeklyExportPart part;
+        if (run.day < today && runs_of_day(run.day) == 1) {
+            part.frag = export_fragment_key(run);
+            const ExportFragment &slot = exportFragments[export_fragment_slot(run.day)];
+            part.cached = slot.valid && slot.same_key(part.frag);
+            part.store = !part.cached;
+        }
+        for (uint32_t i = run.first; i < run.last; ++i) {
+            const DailyLog &d = dailyLogs[i];
+            columnar_add(columns, d);
+            if (!part.cached) part.entries.push_back(d);
+        }
+        parts.push_back(std::move(part));
+    });
+    std::string header = weekly_export_header(now, agg_totals(firstDay, today));
+
+    jobPool.submit([parts = std::move(parts), columns = std::move(columns), header = std::move(header)]() mutable {
+        std::vector<ExportFragment> stored;
+        std::string p = write_weekly_export(parts, header, stored);
+        if (!p.empty()) export_store_register(p);
+        // The twin shares the text export's stamp, whenever the text was finished
+        std::string pc = p.empty() ? std::string() : export_store_at(p.substr(0, p.size() - 4) + ".ptcol", columnar_finish(columns));
+        post_to_ui([p, pc, stored] {
+            for (const ExportFragment &f : stored) exportFragments[export_fragment_slot(f.day)] = f;
+            if (!p.empty()) append_daily_log("EXPORT", std::string("Exported weekly logs to ") + p + (pc.empty() ? "" : " (columnar: " + pc + ")"));
+        });
+    }, JobPriority::Low);
+}
+
+// ----------------------- Write-ahead log & snapshots ----------------------
+// Every state mutation (log append, task op, break start/end, timer change) is
+// written as a typed, sequence-numbered, CRC-protected record to journal.wal
+// before it is applied in memory. Startup loads state.snap and replays the
+// journal tail, so breaks and the session timer survive restarts and crashes.
+// The human-readable files (daily_logs.txt, tasks.txt) remain as mirrors.
+// The snapshot a new one replaces is kept as state.snap.prev, and the journal keeps
+// every record since it, so a damaged state.snap costs nothing: recovery loads
+// state.snap.prev and replays further. If neither is usable (or the journal has a gap)
+// snapshots and compaction stop, so the files on disk are left as they are.
+//
+// Record frame (little-endian):
+//   u32 payload_len | u64 seq | u8 op | payload | u32 crc32(seq..payload)
+// Snapshot: "PTSNAP1\n" | u64 seq | timer | tasks | breaks | logs | u32 crc32
+enum class WalOp : uint8_t {
+    Log = 1,         // ts, s1=type, s2=text
+    TaskAdd = 2,     // s1=name, index=parent
+    TaskDone = 3,    // index, flag=done
+    TaskRemove = 4,  // index (single node; children are removed by their own records)
+    BreakStart = 5,  // s1=type, ts=start, ts2=end (non-zero for retroactive breaks)
+    BreakEnd = 6,    // index into breaks, ts=end
+    TimerPause = 7,  // ts
+    TimerResume = 8, // ts
+    TimerReset = 9,  // ts (new session: accumulated time is dropped)
+    Clear = 10,      // ts
+};
+
+struct WalRecord {
+    uint64_t seq = 0;
+    WalOp op = WalOp::Log;
+    int64_t ts = 0;
+    int64_t ts2 = 0;
+    int32_t index = -1;
+    uint8_t flag = 0;
+    std::string s1;
+    std::string s2;
+};
+
+static const char* WAL_FILE_NAME = "journal.wal";
+static const char* SNAPSHOT_FILE_NAME = "state.snap";
+static const char* SNAPSHOT_PREV_FILE_NAME = "state.snap.prev";
+static const char SNAPSHOT_MAGIC[8] = {'P','T','S','N','A','P','1','\n'};
+static const uint32_t kWalMaxPayload = 16u * 1024u * 1024u;
+static const int kWalSnapshotInterval = 512; // records between automatic snapshots
+
+static FILE* wal_file = nullptr;
+
+// journal.wal for appending, close-on-exec so child processes (the analyzer and
+// whatever it starts) never hold it.
+static FILE* wal_open_append(const std::string &path) {
+#if defined(__linux__)
+    return fopen(path.c_str(), "abe");
+#else
+    FILE* f = fopen(path.c_str(), "ab");
+#ifndef _WIN32
+    if (f) fcntl(fileno(f), F_SETFD, FD_CLOEXEC);
+#endif
+    return f;
+#endif
+}
+static uint64_t wal_next_seq = 1;
+static int wal_records_since_snapshot = 0;
+static time_t wal_last_record_ts = 0;
+static bool wal_snapshot_good = false;   // state.snap on disk loaded or was written by us
+static bool wal_snapshots_frozen = false; // recovery could not rebuild everything: leave files alone
+static long wal_prev_snapshot_cut = 0;   // journal offset of the previous snapshot's cut
+
+static uint32_t crc32_update(uint32_t crc, const unsigned char* data, size_t n) {
+    static uint32_t table[256];
+    static bool init = false;
+    if (!init) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            table[i] = c;
+        }
+        init = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Little-endian byte packing helpers (std::string used as a byte buffer)
+static void put_u8(std::string &b, uint8_t v) { b.push_back((char)v); }
+static void put_u32(std::string &b, uint32_t v) { for (int i = 0; i < 4; ++i) b.push_back((char)((v >> (8*i)) & 0xFF)); }
+static void put_u64(std::string &b, uint64_t v) { for (int i = 0; i < 8; ++i) b.push_back((char)((v >> (8*i)) & 0xFF)); }
+static void put_str(std::string &b, const std::string &s) { put_u32(b, (uint32_t)s.size()); b += s; }
+
+struct ByteReader {
+    const unsigned char* p;
+    size_t n;
+    size_t off = 0;
+    bool ok = true;
+    ByteReader(const std::string &buf, size_t start = 0, size_t len = std::string::npos)
+        : p((const unsigned char*)buf.data() + start), n(len == std::string::npos ? buf.size() - start : len) {}
+    bool need(size_t k) { if (!ok || n - off < k) ok = false; return ok; }
+    uint8_t u8() { if (!need(1)) return 0; return p[off++]; }
+    uint32_t u32() { if (!need(4)) return 0; uint32_t v = 0; for (int i = 0; i < 4; ++i) v |= (uint32_t)p[off+i] << (8*i); off += 4; return v; }
+    uint64_t u64() { if (!need(8)) return 0; uint64_t v = 0; for (int i = 0; i < 8; ++i) v |= (uint64_t)p[off+i] << (8*i); off += 8; return v; }
+    std::string str() { uint32_t len = u32(); if (!need(len)) return std::string(); std::string s((const char*)p + off, len); off += len; return s; }
+};
+
+static void encode_wal_record(std::string &out, const WalRecord &r) {
+    std::string body;
+    put_u64(body, r.seq);
+    put_u8(body, (uint8_t)r.op);
+    put_u64(body, (uint64_t)r.ts);
+    put_u64(body, (uint64_t)r.ts2);
+    put_u32(body, (uint32_t)r.index);
+    put_u8(body, r.flag);
+    put_str(body, r.s1);
+    put_str(body, r.s2);
+    uint32_t payload_len = (uint32_t)(body.size() - 9); // excludes seq + op
+    put_u32(out, payload_len);
+    out += body;
+    put_u32(out, crc32_update(0, (const unsigned char*)body.data(), body.size()));
+}
+
+// Decodes one record at `off`. Returns false on a short, oversized or corrupt frame.
+static bool decode_wal_record(const std::string &buf, size_t &off, WalRecord &r) {
+    ByteReader hdr(buf, off);
+    uint32_t payload_len = hdr.u32();
+    if (!hdr.ok || payload_len > kWalMaxPayload) return false;
+    size_t body_len = 9 + (size_t)payload_len;
+    if (buf.size() - off < 4 + body_len + 4) return false;
+    const unsigned char* body = (const unsigned char*)buf.data() + off + 4;
+    ByteReader crcr(buf, off + 4 + body_len, 4);
+    if (crc32_update(0, body, body_len) != crcr.u32()) return false;
+
+    ByteReader br(buf, off + 4, body_len);
+    r.seq = br.u64();
+    r.op = (WalOp)br.u8();
+    r.ts = (int64_t)br.u64();
+    r.ts2 = (int64_t)br.u64();
+    r.index = (int32_t)br.u32();
+    r.flag = br.u8();
+    r.s1 = br.str();
+    r.s2 = br.str();
+    if (!br.ok) return false;
+    off += 4 + body_len + 4;
+    return true;
+}
+
+static void search_index_on_append();
+static void search_index_clear();
+static void trigram_index_on_append();
+static void trigram_index_clear();
+static void status_page_publish();
+
+// Removes a single task and re-points parent references above it.
+static void erase_task_at(int idx) {
+    if (idx < 0 || idx >= (int)tasks.size()) return;
+    tasks.erase(tasks.begin() + idx);
+    for (auto &t : tasks) {
+        if (t.parent == idx) t.parent = -1;
+        else if (t.parent > idx) --t.parent;
     }
-    f.close();
+    if (new_task_parent_idx == idx) new_task_parent_idx = -1;
+    else if (new_task_parent_idx > idx) --new_task_parent_idx;
+    ++tasks_version;
+}
+
+// Applies a record to in-memory state. Shared by the live path and replay, so it
+// must not write any files itself.
+static void wal_apply(const WalRecord &r) {
+    switch (r.op) {
+    case WalOp::Log:
+        dailyLogs.push_back(DailyLog{ (time_t)r.ts, r.s1, r.s2 });
+        day_index_append(dailyLogs.size() - 1);
+        search_index_on_append();
+        trigram_index_on_append();
+        if (r.s1 == "HOURLY") agg_count_hourly_entry((time_t)r.ts);
+        break;
+    case WalOp::TaskAdd: {
+        Task t; t.name = r.s1; t.parent = r.index; t.done = false;
+        tasks.push_back(t);
+        ++tasks_version;
+        break;
+    }
+    case WalOp::TaskDone:
+        if (r.index >= 0 && r.index < (int)tasks.size()) {
+            if (r.flag && !tasks[r.index].done) agg_count_task_completed((time_t)r.ts);
+            tasks[r.index].done = (r.flag != 0);
+        }
+        break;
+    case WalOp::TaskRemove:
+        erase_task_at(r.index);
+        break;
+    case WalOp::BreakStart: {
+        BreakEntry b; b.type = r.s1; b.start = (time_t)r.ts; b.end = (time_t)r.ts2;
+        breaks.push_back(b);
+        if (b.end == 0) index_break_started((int)breaks.size() - 1);
+        else agg_add_interval(b.start, b.end, break_type_slot(b.type));
+        break;
+    }
+    case WalOp::BreakEnd:
+        if (r.index >= 0 && r.index < (int)breaks.size() && breaks[r.index].end == 0) {
+            breaks[r.index].end = (time_t)r.ts;
+            index_break_ended(r.index);
+            agg_add_interval(breaks[r.index].start, breaks[r.index].end, break_type_slot(breaks[r.index].type));
+        }
+        break;
+    case WalOp::TimerPause:
+        if (tracking_start_time != 0) {
+            agg_add_interval(tracking_start_time, (time_t)r.ts, -1);
+            if ((time_t)r.ts > tracking_start_time) accumulated_tracked_seconds += (long)((time_t)r.ts - tracking_start_time);
+            tracking_start_time = 0;
+        }
+        break;
+    case WalOp::TimerResume:
+        if (tracking_start_time == 0) tracking_start_time = (time_t)r.ts;
+        break;
+    case WalOp::TimerReset:
+        app_start_time = (time_t)r.ts;
+        tracking_start_time = (time_t)r.ts;
+        accumulated_tracked_seconds = 0;
+        break;
+    case WalOp::Clear:
+        dailyLogs.clear();
+        breaks.clear();
+        tasks.clear();
+        new_task_parent_idx = -1;
+        ++tasks_version;
+        rebuild_active_break_index();
+        rebuild_day_index();
+        search_index_clear();
+        trigram_index_clear();
+        agg_clear();
+        app_start_time = (time_t)r.ts;
+        tracking_start_time = (time_t)r.ts;
+        accumulated_tracked_seconds = 0;
+        break;
+    }
+    if (r.ts != 0) wal_last_record_ts = (time_t)r.ts;
+    // Session-level changes go to the shared-memory status page
+    bool taskOp = r.op == WalOp::TaskAdd || r.op == WalOp::TaskDone || r.op == WalOp::TaskRemove;
+    if (!taskOp && (r.op != WalOp::Log || r.s1 == "HOURLY")) status_page_publish();
+}
 
-    // Launch async so UI doesn't block
-    std::thread([path]() {
+static void wal_sync_file(FILE* f) {
+    fflush(f);
 #ifdef _WIN32
-        // Use start to detach the process on Windows
-        std::string cmd = std::string("start \"\" python \"") + path + "\"";
-        system(cmd.c_str());
+    _commit(_fileno(f));
 #else
-        // Use python3 if available, otherwise python, run with nohup in background
-        std::string cmd = std::string("nohup python3 \"") + path + "\" >/dev/null 2>&1 &";
-        if (system(cmd.c_str()) != 0) {
-            std::string cmd2 = std::string("nohup python \"") + path + "\" >/dev/null 2>&1 &";
-            system(cmd2.c_str());
+    fsync(fileno(f));
+#endif
+}
+
+static bool read_whole_file(const std::string &path, std::string &out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+static std::string serialize_aggregates(uint64_t seq) {
+    std::string b(AGGREGATES_MAGIC, sizeof(AGGREGATES_MAGIC));
+    put_u64(b, seq);
+    put_u32(b, (uint32_t)dayAggregates.size());
+    for (const auto &d : dayAggregates) {
+        put_u32(b, (uint32_t)d.day);
+        uint32_t mask = 0;
+        for (int h = 0; h < 24; ++h) if (!d.hours[h].empty()) mask |= (1u << h);
+        put_u32(b, mask);
+        for (int h = 0; h < 24; ++h) {
+            if (!(mask & (1u << h))) continue;
+            const HourBucket &hb = d.hours[h];
+            put_u32(b, hb.tracked_seconds);
+            for (uint32_t s : hb.break_seconds) put_u32(b, s);
+            put_u32(b, hb.hourly_entries);
+            put_u32(b, hb.tasks_completed);
+        }
+    }
+    put_u32(b, crc32_update(0, (const unsigned char*)b.data(), b.size()));
+    return b;
+}
+
+// Loads aggregates.bin only if it was written together with the snapshot at `seq`.
+static bool agg_load(uint64_t seq) {
+    std::string b;
+    if (!read_whole_file(path_in_data(AGGREGATES_FILE_NAME), b)) return false;
+    if (b.size() < sizeof(AGGREGATES_MAGIC) + 16 || std::memcmp(b.data(), AGGREGATES_MAGIC, sizeof(AGGREGATES_MAGIC)) != 0) return false;
+    ByteReader crcr(b, b.size() - 4, 4);
+    if (crc32_update(0, (const unsigned char*)b.data(), b.size() - 4) != crcr.u32()) return false;
+    ByteReader r(b, sizeof(AGGREGATES_MAGIC), b.size() - sizeof(AGGREGATES_MAGIC) - 4);
+    if (r.u64() != seq) return false;
+    std::vector<DayAggregate> days(r.u32());
+    for (auto &d : days) {
+        if (!r.ok) break;
+        d.day = (int32_t)r.u32();
+        uint32_t mask = r.u32();
+        for (int h = 0; h < 24; ++h) {
+            if (!(mask & (1u << h))) continue;
+            HourBucket &hb = d.hours[h];
+            hb.tracked_seconds = r.u32();
+            for (uint32_t &s : hb.break_seconds) s = r.u32();
+            hb.hourly_entries = r.u32();
+            hb.tasks_completed = r.u32();
         }
+    }
+    if (!r.ok) return false;
+    dayAggregates.swap(days);
+    ++agg_version;
+    return true;
+}
+
+// Fallback when aggregates.bin is missing or stale: rebuilds what the logs and break
+// history can tell us. Tracked time before this point cannot be recovered.
+static void agg_rebuild_from_state() {
+    agg_clear();
+    for (const auto &d : dailyLogs) {
+        if (d.type == "HOURLY") agg_count_hourly_entry(d.ts);
+        else if (d.type == "TASK" && d.text.rfind("Toggled task: ", 0) == 0 && d.text.size() >= 7
+                 && d.text.compare(d.text.size() - 7, 7, " [done]") == 0) agg_count_task_completed(d.ts);
+    }
+    for (const auto &b : breaks) if (b.end) agg_add_interval(b.start, b.end, break_type_slot(b.type));
+}
+
+// Write-then-rename so a crash never leaves a half-written file behind
+static bool write_file_atomic(const std::string &path, const std::string &bytes) {
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    wal_sync_file(f);
+    fclose(f);
+    if (!ok) { std::remove(tmp.c_str()); return false; }
+#ifdef _WIN32
+    std::remove(path.c_str());
 #endif
-    }).detach();
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
 
-    append_daily_log("ANALYSIS", std::string("Launched analyze_productivity script: ") + path);
+static std::string serialize_snapshot(uint64_t seq) {
+    std::string b(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    put_u64(b, seq);
+    put_u64(b, (uint64_t)app_start_time);
+    put_u64(b, (uint64_t)tracking_start_time);
+    put_u64(b, (uint64_t)accumulated_tracked_seconds);
+    put_u32(b, (uint32_t)tasks.size());
+    for (const auto &t : tasks) { put_str(b, t.name); put_u32(b, (uint32_t)t.parent); put_u8(b, t.done ? 1 : 0); }
+    put_u32(b, (uint32_t)breaks.size());
+    for (const auto &br : breaks) { put_str(b, br.type); put_u64(b, (uint64_t)br.start); put_u64(b, (uint64_t)br.end); }
+    put_u32(b, (uint32_t)dailyLogs.size());
+    for (const auto &d : dailyLogs) { put_u64(b, (uint64_t)d.ts); put_str(b, d.type); put_str(b, d.text); }
+    put_u32(b, crc32_update(0, (const unsigned char*)b.data(), b.size()));
+    return b;
 }
 
-// ----------------------- ImGui theme & helpers ----------------------------
-static void ApplyGrayTheme() {
-    ImGuiStyle &style = ImGui::GetStyle();
-    style.WindowRounding = 6.0f;
-    style.FrameRounding = 4.0f;
-    style.GrabRounding = 4.0f;
-    style.WindowBorderSize = 1.0f;
-    style.FrameBorderSize = 1.0f;
-    style.ChildBorderSize = 1.0f;
-    style.PopupBorderSize = 1.0f;
+// Aggregates first: a crash in between leaves them tagged with a newer seq than
+// the snapshot, which agg_load() rejects and recovery rebuilds.
+// A good state.snap is kept as state.snap.prev (a hard link where possible) first.
+static bool write_snapshot_files(const std::string &snap, const std::string &agg, bool keepPrev) {
+    write_file_atomic(path_in_data(AGGREGATES_FILE_NAME), agg);
+    std::string path = path_in_data(SNAPSHOT_FILE_NAME), prev = path_in_data(SNAPSHOT_PREV_FILE_NAME);
+    if (keepPrev) {
+        std::remove(prev.c_str());
+#ifndef _WIN32
+        bool linked = link(path.c_str(), prev.c_str()) == 0;
+#else
+        bool linked = false;
+#endif
+        std::string old;
+        if (!linked && read_whole_file(path, old)) write_file_atomic(prev, old);
+    }
+    return write_file_atomic(path, snap);
+}
 
-    ImVec4 bg     = ImVec4(0.05f,0.05f,0.06f,1.0f);
-    ImVec4 bgAlt  = ImVec4(0.09f,0.09f,0.10f,1.0f);
-    ImVec4 pane   = ImVec4(0.12f,0.12f,0.13f,1.0f);
-    ImVec4 text   = ImVec4(0.92f,0.92f,0.93f,1.0f);
-    ImVec4 accent = ImVec4(0.20f,0.55f,0.90f,1.0f);
-    ImVec4 border = ImVec4(0.13f,0.13f,0.14f,1.0f);
+// Current end of the journal; everything before it is covered by a snapshot taken now.
+static long wal_journal_end() {
+    if (!wal_file) return 0;
+    fflush(wal_file);
+    fseek(wal_file, 0, SEEK_END);
+    return ftell(wal_file);
+}
 
-    style.Colors[ImGuiCol_WindowBg]             = bg;
-    style.Colors[ImGuiCol_ChildBg]              = bgAlt;
-    style.Colors[ImGuiCol_FrameBg]              = pane;
-    style.Colors[ImGuiCol_FrameBgHovered]       = ImVec4(0.18f,0.18f,0.2f,1.0f);
-    style.Colors[ImGuiCol_FrameBgActive]        = ImVec4(0.22f,0.22f,0.24f,1.0f);
-    style.Colors[ImGuiCol_TitleBg]              = bg;
-    style.Colors[ImGuiCol_TitleBgActive]        = bg;
-    style.Colors[ImGuiCol_MenuBarBg]            = bgAlt;
-    style.Colors[ImGuiCol_Header]               = pane;
-    style.Colors[ImGuiCol_HeaderHovered]        = ImVec4(0.16f,0.16f,0.18f,1.0f);
-    style.Colors[ImGuiCol_Button]               = ImVec4(0.14f,0.14f,0.16f,1.0f);
-    style.Colors[ImGuiCol_ButtonHovered]        = accent;
-    style.Colors[ImGuiCol_ButtonActive]         = ImVec4(accent.x*0.9f, accent.y*0.9f, accent.z*0.9f, 1.0f);
-    style.Colors[ImGuiCol_Text]                 = text;
-    style.Colors[ImGuiCol_TextDisabled]         = ImVec4(0.6f,0.6f,0.62f,1.0f);
-    style.Colors[ImGuiCol_Border]               = border;
-    style.Colors[ImGuiCol_ScrollbarBg]          = bgAlt;
-    style.Colors[ImGuiCol_ScrollbarGrab]        = pane;
-    style.Colors[ImGuiCol_PopupBg]              = bgAlt;
+// Called once the snapshot taken at journal offset `cut` is durable. Drops the records
+// the previous snapshot (now state.snap.prev) covers: the journal always reaches back
+// to it, so recovery can fall back to it.
+static void wal_compact_journal(long cut) {
+    long drop = wal_prev_snapshot_cut;
+    wal_prev_snapshot_cut = cut - drop;
+    if (!wal_file || drop <= 0) return;
+    std::string path = path_in_data(WAL_FILE_NAME);
+    fclose(wal_file);
+    wal_file = nullptr;
+    std::string journal;
+    if (read_whole_file(path, journal) && (size_t)drop <= journal.size())
+        write_file_atomic(path, journal.substr((size_t)drop));
+    wal_file = wal_open_append(path);
 }
 
-// ----------------------- Forwarding callbacks -----------------------------
-static GLFWmousebuttonfun prev_mousebutton_cb = nullptr;
-static GLFWscrollfun prev_scroll_cb = nullptr;
-static GLFWkeyfun prev_key_cb = nullptr;
-static GLFWcharfun prev_char_cb = nullptr;
-static GLFWcursorposfun prev_cursorpos_cb = nullptr;
-static GLFWcursorenterfun prev_cursorenter_cb = nullptr;
+// At most one background snapshot at a time; journal offsets are only valid until the
+// next compaction. A request made while one is running is re-issued when it finishes.
+static bool wal_snapshot_in_flight = false;
+static bool wal_snapshot_requested = false;
+
+static bool wal_write_snapshot(bool async = false) {
+    if (wal_snapshot_in_flight) { wal_snapshot_requested = true; return false; }
+    if (wal_snapshots_frozen) { wal_records_since_snapshot = 0; return false; }
+    uint64_t seq = wal_next_seq - 1;
+    std::string snap = serialize_snapshot(seq);
+    std::string agg = serialize_aggregates(seq);
+    long cut = wal_journal_end();
+    wal_records_since_snapshot = 0;
+
+    bool keepPrev = wal_snapshot_good;
+    if (!async) {
+        if (!write_snapshot_files(snap, agg, keepPrev)) return false;
+        wal_snapshot_good = true;
+        wal_compact_journal(cut);
+        return true;
+    }
 
-static void forward_mousebutton_cb(GLFWwindow* w, int button, int action, int mods) {
-    ImGui_ImplGlfw_MouseButtonCallback(w, button, action, mods);
-    if (prev_mousebutton_cb) prev_mousebutton_cb(w, button, action, mods);
+    // Serialization happens here on the UI thread; the slow part (write + fsync) on the pool.
+    wal_snapshot_in_flight = true;
+    jobPool.submit([snap = std::move(snap), agg = std::move(agg), cut, keepPrev]() {
+        bool ok = write_snapshot_files(snap, agg, keepPrev);
+        post_to_ui([ok, cut] {
+            wal_snapshot_in_flight = false;
+            if (ok) { wal_snapshot_good = true; wal_compact_journal(cut); }
+            else fprintf(stderr, "state.snap write failed; journal kept\n");
+            if (wal_snapshot_requested) {
+                wal_snapshot_requested = false;
+                wal_write_snapshot(true);
+            }
+        });
+    }, JobPriority::Low);
+    return true;
 }
-static void forward_scroll_cb(GLFWwindow* w, double xoffset, double yoffset) {
-    ImGui_ImplGlfw_ScrollCallback(w, xoffset, yoffset);
-    if (prev_scroll_cb) prev_scroll_cb(w, xoffset, yoffset);
+
+static bool wal_load_snapshot_file(const char* name, uint64_t &snap_seq) {
+    std::string b;
+    if (!read_whole_file(path_in_data(name), b)) return false;
+    if (b.size() < sizeof(SNAPSHOT_MAGIC) + 4 || std::memcmp(b.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        fprintf(stderr, "%s is not a snapshot, ignoring it\n", name);
+        return false;
+    }
+    ByteReader crcr(b, b.size() - 4, 4);
+    if (crc32_update(0, (const unsigned char*)b.data(), b.size() - 4) != crcr.u32()) {
+        fprintf(stderr, "%s checksum mismatch, ignoring it\n", name);
+        return false;
+    }
+    ByteReader r(b, sizeof(SNAPSHOT_MAGIC), b.size() - sizeof(SNAPSHOT_MAGIC) - 4);
+    std::vector<Task> snapTasks;
+    std::vector<BreakEntry> snapBreaks;
+    std::vector<DailyLog> snapLogs;
+    uint64_t seq = r.u64();
+    time_t start = (time_t)r.u64();
+    time_t tracking = (time_t)r.u64();
+    long accumulated = (long)r.u64();
+    uint32_t nt = r.u32();
+    for (uint32_t i = 0; i < nt && r.ok; ++i) {
+        Task t; t.name = r.str(); t.parent = (int)(int32_t)r.u32(); t.done = r.u8() != 0;
+        snapTasks.push_back(t);
+    }
+    uint32_t nb = r.u32();
+    for (uint32_t i = 0; i < nb && r.ok; ++i) {
+        BreakEntry br; br.type = r.str(); br.start = (time_t)r.u64(); br.end = (time_t)r.u64();
+        snapBreaks.push_back(br);
+    }
+    uint32_t nl = r.u32();
+    snapLogs.reserve(nl);
+    for (uint32_t i = 0; i < nl && r.ok; ++i) {
+        DailyLog d; d.ts = (time_t)r.u64(); d.type = r.str(); d.text = r.str();
+        snapLogs.push_back(std::move(d));
+    }
+    if (!r.ok) return false;
+
+    snap_seq = seq;
+    app_start_time = start;
+    tracking_start_time = tracking;
+    accumulated_tracked_seconds = accumulated;
+    tasks.swap(snapTasks);
+    ++tasks_version;
+    breaks.swap(snapBreaks);
+    dailyLogs.swap(snapLogs);
+    rebuild_active_break_index();
+    rebuild_day_index();
+    return true;
 }
-static void forward_key_cb(GLFWwindow* w, int key, int scancode, int action, int mods) {
-    ImGui_ImplGlfw_KeyCallback(w, key, scancode, action, mods);
-    if (prev_key_cb) prev_key_cb(w, key, scancode, action, mods);
+
+// state.snap, or state.snap.prev if state.snap is unreadable. False if neither loads.
+static bool wal_load_snapshot(uint64_t &snap_seq) {
+    wal_snapshot_good = wal_load_snapshot_file(SNAPSHOT_FILE_NAME, snap_seq);
+    if (wal_snapshot_good) return true;
+    struct stat st;
+    if (stat(path_in_data(SNAPSHOT_FILE_NAME).c_str(), &st) != 0) return false;
+    if (!wal_load_snapshot_file(SNAPSHOT_PREV_FILE_NAME, snap_seq)) return false;
+    fprintf(stderr, "state.snap is damaged; loaded state.snap.prev (seq %llu) instead\n", (unsigned long long)snap_seq);
+    return true;
 }
-static void forward_char_cb(GLFWwindow* w, unsigned int c) {
-    ImGui_ImplGlfw_CharCallback(w, c);
-    if (prev_char_cb) prev_char_cb(w, c);
+
+// Appends a record to the journal and applies it. All live mutations go through here.
+// Group commit: between wal_begin_batch() and wal_end_batch() records are written as
+// usual but the journal is fsynced once, at the end, and the storage backend's log/task
+// writes are grouped (one append, one transaction). Used by the IPC endpoint and
+// end_day_action to absorb bursts; callers must not acknowledge anything to the
+// outside world before wal_end_batch().
+static int wal_batch_depth = 0;
+static bool wal_batch_unsynced = false;
+static bool wal_batch_tasks_dirty = false;
+
+static void wal_begin_batch() { if (wal_batch_depth++ == 0) storage_begin_batch(); }
+static void wal_end_batch();
+
+static void wal_commit(WalRecord r) {
+    // A secondary instance never writes; its helpers forward to the primary instead
+    if (instance_is_secondary()) {
+        fprintf(stderr, "secondary instance: dropped a change (op %d) that cannot be forwarded\n", (int)r.op);
+        return;
+    }
+    r.seq = wal_next_seq++;
+    if (wal_file) {
+        std::string frame;
+        encode_wal_record(frame, r);
+        if (fwrite(frame.data(), 1, frame.size(), wal_file) != frame.size())
+            fprintf(stderr, "journal.wal write failed (seq %llu)\n", (unsigned long long)r.seq);
+        if (wal_batch_depth > 0) wal_batch_unsynced = true;
+        else wal_sync_file(wal_file);
+    }
+    wal_apply(r);
+    if (++wal_records_since_snapshot >= kWalSnapshotInterval) wal_write_snapshot(true);
 }
-static void forward_cursorpos_cb(GLFWwindow* w, double xpos, double ypos) {
-    ImGui_ImplGlfw_CursorPosCallback(w, xpos, ypos);
-    if (prev_cursorpos_cb) prev_cursorpos_cb(w, xpos, ypos);
+
+static void wal_commit_op(WalOp op, time_t ts) {
+    WalRecord r; r.op = op; r.ts = ts;
+    wal_commit(r);
 }
-static void forward_cursorenter_cb(GLFWwindow* w, int entered) {
-    ImGui_ImplGlfw_CursorEnterCallback(w, entered);
-    if (prev_cursorenter_cb) prev_cursorenter_cb(w, entered);
+
+static void load_tasks();
+static void load_daily_logs();
+static void rebuild_breaks_from_logs();
+static void wal_resume_session();
+
+// Rebuilds in-memory state from state.snap + journal.wal. Falls back to the legacy
+// text files (and converts them into a first snapshot) when neither exists yet.
+static void wal_recover() {
+    std::string walPath = path_in_data(WAL_FILE_NAME);
+    std::string journal;
+    bool haveJournal = read_whole_file(walPath, journal);
+    uint64_t snapSeq = 0;
+    bool haveSnapshot = wal_load_snapshot(snapSeq);
+    struct stat st;
+    bool snapshotLost = !haveSnapshot && stat(path_in_data(SNAPSHOT_FILE_NAME).c_str(), &st) == 0;
+
+    if (!haveSnapshot && !haveJournal && !snapshotLost) {
+        load_tasks();
+        load_daily_logs();
+        rebuild_day_index();
+        rebuild_breaks_from_logs();
+        agg_rebuild_from_state();
+        wal_next_seq = 1;
+        wal_write_snapshot();
+    } else {
+        if (!agg_load(snapSeq)) agg_rebuild_from_state();
+        size_t off = 0, good = 0;
+        uint64_t lastSeq = snapSeq;
+        size_t replayed = 0;
+        WalRecord r;
+        bool gap = false;
+        while (off < journal.size() && decode_wal_record(journal, off, r)) {
+            if (r.seq > lastSeq + 1) gap = true;
+            if (r.seq > lastSeq) {
+                wal_apply(r);
+                lastSeq = r.seq;
+                ++replayed;
+            }
+            good = off;
+        }
+        wal_next_seq = lastSeq + 1;
+        wal_records_since_snapshot = (int)replayed;
+        if (gap || (snapshotLost && lastSeq == 0)) {
+            // Part of the history is missing; a new snapshot or a compaction would make
+            // that permanent
+            wal_snapshots_frozen = true;
+            fprintf(stderr, "%s: part of the history could not be recovered (damaged snapshot or a gap in journal.wal); "
+                    "no snapshots are written and the journal is not compacted this run. Move state.snap away "
+                    "to accept the recovered state.\n", user_data_dir().c_str());
+        }
+
+        // Drop a torn or corrupt tail so new records append after the last good frame
+        if (good < journal.size()) {
+            fprintf(stderr, "journal.wal: discarding %zu trailing bytes after seq %llu\n",
+                    journal.size() - good, (unsigned long long)lastSeq);
+            std::ofstream f(walPath, std::ios::binary | std::ios::trunc);
+            f.write(journal.data(), (std::streamsize)good);
+        }
+    }
+
+    wal_resume_session();
 }
-static void InstallForwardingCallbacks(GLFWwindow* window) {
-    prev_mousebutton_cb = glfwSetMouseButtonCallback(window, forward_mousebutton_cb);
-    prev_scroll_cb = glfwSetScrollCallback(window, forward_scroll_cb);
-    prev_key_cb = glfwSetKeyCallback(window, forward_key_cb);
-    prev_char_cb = glfwSetCharCallback(window, forward_char_cb);
-    prev_cursorpos_cb = glfwSetCursorPosCallback(window, forward_cursorpos_cb);
-    prev_cursorenter_cb = glfwSetCursorEnterCallback(window, forward_cursorenter_cb);
+
+// Opens journal.wal for appending and starts this run's session timer. The second half
+// of wal_recover(); a secondary instance runs it when it takes over as the primary.
+static void wal_resume_session() {
+    std::string walPath = path_in_data(WAL_FILE_NAME);
+    if (!wal_file) wal_file = wal_open_append(walPath);
+    if (!wal_file) fprintf(stderr, "could not open %s for writing; changes will not be persisted\n", walPath.c_str());
+
+    time_t now = time(nullptr);
+    if (app_start_time == 0) {
+        wal_commit_op(WalOp::TimerReset, now);
+        return;
+    }
+    // The previous run did not shut down cleanly: stop counting at its last recorded activity.
+    if (tracking_start_time != 0) wal_commit_op(WalOp::TimerPause, wal_last_record_ts ? wal_last_record_ts : now);
+    if (active_breaks_count() == 0) wal_commit_op(WalOp::TimerResume, now);
+}
+
+// Clean shutdown: stop the session timer and compact the journal into a snapshot.
+static void run_ui_completions();
+static void wal_shutdown() {
+    if (tracking_start_time != 0) wal_commit_op(WalOp::TimerPause, time(nullptr));
+    while (wal_snapshot_in_flight) {
+        run_ui_completions();
+        std::this_thread::yield();
+    }
+    wal_write_snapshot();
+    if (wal_file) { fclose(wal_file); wal_file = nullptr; }
 }
 
-// ----------------------- UI helpers --------------------------------------
-static std::string makeButtonLabel(const std::string &visible, const std::string &uniqueId) {
-    return visible + "###" + uniqueId;
-}
+// ----------------------- Search index -------------------------------------
+// Inverted index over dailyLogs: token -> posting list of log indices (which only
+// grow, since logs are append-only until Clear). Postings are delta + varint encoded
+// with a skip entry every kSkipInterval postings so AND queries can jump ahead.
+// Tokens are lowercased runs of letters/digits (bytes >= 0x80 count as letters);
+// the log type is indexed too. Queries: words are ANDed, `word*` is a prefix match,
+// "quoted text" is a phrase (its words are ANDed, then candidates are checked for the
+// words as consecutive tokens).
+//
+// Saved to search.idx on clean exit. On startup a saved index that still matches
+// the first N logs is reused and only newer logs are indexed.
+static const char* SEARCH_INDEX_FILE_NAME = "search.idx";
+static const char SEARCH_INDEX_MAGIC[8] = {'P','T','F','T','S','0','1','\n'};
+static const uint32_t kSkipInterval = 64;
+static const size_t kMaxTokenLen = 32;
+
+struct SkipEntry {
+    uint32_t doc;    // doc id of the kSkipInterval-th posting
+    uint32_t offset; // byte offset just after it
+};
+struct PostingList {
+    std::string bytes;
+    std::vector<SkipEntry> skips;
+    uint32_t last = 0;
+    uint32_t count = 0;
+};
+struct SearchIndex {
+    std::map<std::string, PostingList> terms; // ordered, for prefix lookups
+    uint32_t docCount = 0;                    // dailyLogs[0, docCount) are indexed
+    bool ready = false;                       // false while recovery is rebuilding dailyLogs
+};
+static SearchIndex searchIndex;
+
+static void put_varint(std::string &b, uint32_t v) {
+    while (v >= 0x80) { b.push_back((char)(v | 0x80)); v >>= 7; }
+    b.push_back((char)v);
+}
+static uint32_t get_varint(const std::string &b, size_t &off) {
+    uint32_t v = 0;
+    for (int shift = 0; off < b.size() && shift < 35; shift += 7) {
+        uint8_t c = (uint8_t)b[off++];
+        v |= (uint32_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) break;
+    }
+    return v;
+}
+
+static bool is_token_byte(unsigned char c) { return std::isalnum(c) || c >= 0x80; }
+
+// Calls fn(token) for every lowercased token in s.
+template <typename Fn>
+static void for_each_token(const std::string &s, Fn fn) {
+    std::string tok;
+    for (size_t i = 0; i <= s.size(); ++i) {
+        unsigned char c = (i < s.size()) ? (unsigned char)s[i] : 0;
+        if (c && is_token_byte(c)) {
+            if (tok.size() < kMaxTokenLen) tok.push_back((char)std::tolower(c));
+        } else if (!tok.empty()) {
+            fn(tok);
+            tok.clear();
+        }
+    }
+}
+
+static void posting_append(PostingList &pl, uint32_t doc) {
+    if (pl.count > 0 && pl.last == doc) return; // token repeated within the same entry
+    put_varint(pl.bytes, pl.count == 0 ? doc : doc - pl.last);
+    pl.last = doc;
+    ++pl.count;
+    if (pl.count % kSkipInterval == 0) pl.skips.push_back(SkipEntry{ doc, (uint32_t)pl.bytes.size() });
+}
+
+static void search_index_add_doc(uint32_t doc) {
+    const DailyLog &d = dailyLogs[doc];
+    auto add = [doc](const std::string &tok) { posting_append(searchIndex.terms[tok], doc); };
+    for_each_token(d.type, add);
+    for_each_token(d.text, add);
+}
+// The tokens search_index_add_doc indexes, in order; phrases are verified against
+// them, so a phrase may include the type ("hourly fixed") and ignores punctuation.
+static std::vector<std::string> search_doc_tokens(const DailyLog &d) {
+    std::vector<std::string> toks;
+    auto add = [&toks](const std::string &tok) { toks.push_back(tok); };
+    for_each_token(d.type, add);
+    for_each_token(d.text, add);
+    return toks;
+}
+// Hook for wal_apply: indexes any logs appended since the last call.
+static void search_index_on_append() {
+    if (!searchIndex.ready) return;
+    while (searchIndex.docCount < dailyLogs.size()) search_index_add_doc(searchIndex.docCount++);
+}
+static void search_index_clear() {
+    searchIndex.terms.clear();
+    searchIndex.docCount = 0;
+}
+
+// Forward iterator over a posting list with skip-assisted advance_to().
+struct PostingCursor {
+    const PostingList* pl;
+    size_t off = 0;
+    uint32_t read = 0;
+    uint32_t doc = 0;
+    explicit PostingCursor(const PostingList* p) : pl(p) {}
+    bool next() {
+        if (read >= pl->count) return false;
+        uint32_t v = get_varint(pl->bytes, off);
+        doc = (read == 0) ? v : doc + v;
+        ++read;
+        return true;
+    }
+    // Positions on the first doc >= target; false if the list is exhausted.
+    bool advance_to(uint32_t target) {
+        if (read > 0 && doc >= target) return true;
+        auto it = std::lower_bound(pl->skips.begin(), pl->skips.end(), target,
+                                   [](const SkipEntry &s, uint32_t t) { return s.doc < t; });
+        if (it != pl->skips.begin()) {
+            const SkipEntry &s = *(it - 1);
+            uint32_t skipRead = (uint32_t)((it - 1) - pl->skips.begin() + 1) * kSkipInterval;
+            if (skipRead > read) { off = s.offset; doc = s.doc; read = skipRead; }
+        }
+        while (read == 0 || doc < target) if (!next()) return false;
+        return true;
+    }
+};
+
+static uint64_t fnv1a(const std::string &s, uint64_t h = 1469598103934665603ull) {
+    for (unsigned char c : s) { h ^= c; h *= 1099511628211ull; }
+    return h;
+}
+// Identifies the last indexed log so a saved index is only reused for the same history.
+static uint64_t search_doc_fingerprint(uint32_t docCount) {
+    if (docCount == 0 || docCount > dailyLogs.size()) return 0;
+    const DailyLog &d = dailyLogs[docCount - 1];
+    return fnv1a(d.text, fnv1a(d.type, (uint64_t)d.ts * 1099511628211ull));
+}
+
+static bool search_index_save() {
+    std::string b(SEARCH_INDEX_MAGIC, sizeof(SEARCH_INDEX_MAGIC));
+    put_u32(b, searchIndex.docCount);
+    put_u64(b, search_doc_fingerprint(searchIndex.docCount));
+    put_u32(b, (uint32_t)searchIndex.terms.size());
+    for (const auto &kv : searchIndex.terms) {
+        put_str(b, kv.first);
+        put_u32(b, kv.second.count);
+        put_u32(b, kv.second.last);
+        put_str(b, kv.second.bytes);
+        put_u32(b, (uint32_t)kv.second.skips.size());
+        for (const auto &s : kv.second.skips) { put_u32(b, s.doc); put_u32(b, s.offset); }
+    }
+    put_u32(b, crc32_update(0, (const unsigned char*)b.data(), b.size()));
+    return write_file_atomic(path_in_data(SEARCH_INDEX_FILE_NAME), b);
+}
+
+static bool search_index_load() {
+    std::string b;
+    if (!read_whole_file(path_in_data(SEARCH_INDEX_FILE_NAME), b)) return false;
+    if (b.size() < sizeof(SEARCH_INDEX_MAGIC) + 20 || std::memcmp(b.data(), SEARCH_INDEX_MAGIC, sizeof(SEARCH_INDEX_MAGIC)) != 0) return false;
+    ByteReader crcr(b, b.size() - 4, 4);
+    if (crc32_update(0, (const unsigned char*)b.data(), b.size() - 4) != crcr.u32()) return false;
+    ByteReader r(b, sizeof(SEARCH_INDEX_MAGIC), b.size() - sizeof(SEARCH_INDEX_MAGIC) - 4);
+    uint32_t docCount = r.u32();
+    uint64_t fp = r.u64();
+    if (docCount > dailyLogs.size() || fp != search_doc_fingerprint(docCount)) return false;
+    std::map<std::string, PostingList> terms;
+    uint32_t n = r.u32();
+    for (uint32_t i = 0; i < n && r.ok; ++i) {
+        std::string tok = r.str();
+        PostingList pl;
+        pl.count = r.u32();
+        pl.last = r.u32();
+        pl.bytes = r.str();
+        uint32_t ns = r.u32();
+        if (!r.need((size_t)ns * 8)) break;
+        pl.skips.resize(ns);
+        for (auto &s : pl.skips) { s.doc = r.u32(); s.offset = r.u32(); }
+        terms.emplace_hint(terms.end(), std::move(tok), std::move(pl));
+    }
+    if (!r.ok) return false;
+    searchIndex.terms.swap(terms);
+    searchIndex.docCount = docCount;
+    return true;
+}
+
+// Called once recovery has rebuilt dailyLogs: reuse search.idx if it matches, then
+// index whatever it does not cover.
+static void search_index_init() {
+    if (!search_index_load()) search_index_clear();
+    searchIndex.ready = true;
+    search_index_on_append();
+}
+
+static std::string to_lower_ascii(const std::string &s) {
+    std::string out(s);
+    for (char &c : out) c = (char)std::tolower((unsigned char)c);
+    return out;
+}
+
+// Runs a query; returns matching log indices, newest first, at most `limit` of them.
+static std::vector<uint32_t> search_logs(const std::string &query, size_t limit) {
+    std::vector<std::string> exact, prefixes;
+    std::vector<std::vector<std::string>> phrases; // token sequences
+    {
+        size_t i = 0;
+        std::string plain;
+        while (i < query.size()) {
+            if (query[i] == '"') {
+                size_t end = query.find('"', i + 1);
+                if (end == std::string::npos) end = query.size();
+                std::vector<std::string> phrase;
+                for_each_token(query.substr(i + 1, end - i - 1), [&](const std::string &t) { exact.push_back(t); phrase.push_back(t); });
+                if (phrase.size() > 1) phrases.push_back(std::move(phrase));
+                i = end + 1;
+            } else {
+                plain.push_back(query[i++]);
+            }
+        }
+        // `word*` marks a prefix term; everything else is an exact token
+        std::istringstream words(plain);
+        std::string w;
+        while (words >> w) {
+            bool isPrefix = w.size() > 1 && w.back() == '*';
+            if (isPrefix) w.pop_back();
+            std::vector<std::string> toks;
+            for_each_token(w, [&](const std::string &t) { toks.push_back(t); });
+            for (size_t k = 0; k < toks.size(); ++k)
+                (isPrefix && k + 1 == toks.size() ? prefixes : exact).push_back(toks[k]);
+        }
+    }
+    std::vector<uint32_t> out;
+    if (exact.empty() && prefixes.empty()) return out;
+
+    std::vector<PostingCursor> cursors;
+    for (const auto &t : exact) {
+        auto it = searchIndex.terms.find(t);
+        if (it == searchIndex.terms.end()) return out;
+        cursors.emplace_back(&it->second);
+    }
+    // Prefix terms are materialized as the sorted union of all their expansions: one
+    // expansion is decoded as is, several are marked in a per-log bitmap, so the cost
+    // stays linear in postings + logs however many words share the prefix
+    std::vector<std::vector<uint32_t>> unions;
+    for (const auto &p : prefixes) {
+        auto first = searchIndex.terms.lower_bound(p), last = first;
+        while (last != searchIndex.terms.end() && last->first.compare(0, p.size(), p) == 0) ++last;
+        if (first == last) return out;
+        std::vector<uint32_t> docs;
+        if (std::next(first) == last) {
+            PostingCursor c(&first->second);
+            while (c.next()) docs.push_back(c.doc);
+        } else {
+            std::vector<bool> seen(searchIndex.docCount);
+            for (auto it = first; it != last; ++it) {
+                PostingCursor c(&it->second);
+                while (c.next()) seen[c.doc] = true;
+            }
+            for (uint32_t doc = 0; doc < searchIndex.docCount; ++doc) if (seen[doc]) docs.push_back(doc);
+        }
+        unions.push_back(std::move(docs));
+    }
+
+    // Drive the intersection from the shortest list
+    std::sort(cursors.begin(), cursors.end(), [](const PostingCursor &a, const PostingCursor &b) { return a.pl->count < b.pl->count; });
+    std::vector<size_t> unionPos(unions.size(), 0);
+    auto matches_all = [&](uint32_t doc, size_t skipCursor, size_t skipUnion) {
+        for (size_t k = 0; k < cursors.size(); ++k) {
+            if (k == skipCursor) continue;
+            if (!cursors[k].advance_to(doc) || cursors[k].doc != doc) return false;
+        }
+        for (size_t k = 0; k < unions.size(); ++k) {
+            if (k == skipUnion) continue;
+            auto &u = unions[k];
+            auto it = std::lower_bound(u.begin() + unionPos[k], u.end(), doc);
+            unionPos[k] = (size_t)(it - u.begin());
+            if (it == u.end() || *it != doc) return false;
+        }
+        if (!phrases.empty()) {
+            std::vector<std::string> toks = search_doc_tokens(dailyLogs[doc]);
+            for (const auto &ph : phrases)
+                if (std::search(toks.begin(), toks.end(), ph.begin(), ph.end()) == toks.end()) return false;
+        }
+        return true;
+    };
+    if (!cursors.empty() && (unions.empty() || cursors[0].pl->count <= unions[0].size())) {
+        PostingCursor &drv = cursors[0];
+        while (drv.next()) if (matches_all(drv.doc, 0, (size_t)-1)) out.push_back(drv.doc);
+    } else {
+        size_t smallest = 0;
+        for (size_t k = 1; k < unions.size(); ++k) if (unions[k].size() < unions[smallest].size()) smallest = k;
+        for (uint32_t doc : unions[smallest]) if (matches_all(doc, (size_t)-1, smallest)) out.push_back(doc);
+    }
+    std::reverse(out.begin(), out.end());
+    if (out.size() > limit) out.resize(limit);
+    return out;
+}
+
+// ----------------------- Trigram index ------------------------------------
+// Substring search for text the word index cannot match (ticket ids, hostnames,
+// partial words). Every log is indexed as its displayed line, lowercased
+// ("2024-05-01 10:00:00 - HOURLY - fixed PROJ-1234"), by all of its 3-byte windows.
+// A query's trigrams select candidates, which are then verified against the line.
+// Fuzzy queries keep candidates sharing enough trigrams and verify them with an
+// approximate substring match (edit distance).
+//
+// The index for existing logs is built on the job pool at startup; until it is
+// handed back, substring queries find nothing. New logs are added as they are applied.
+struct TrigramIndex {
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings; // trigram -> sorted log indices
+    size_t bytes = 0;        // posting arrays + map entries, kept by trigram_add_doc
+    uint32_t docCount = 0;
+    bool ready = false;
+    bool building = false;
+    uint64_t generation = 0; // bumped by Clear so a stale background build is dropped
+};
+static TrigramIndex trigramIndex;
+
+static std::string trigram_doc_text(const DailyLog &d) {
+    return to_lower_ascii(human_log_line(d.type.c_str(), d.text, d.ts));
+}
+static inline uint32_t trigram_key(const char* p) {
+    return (uint32_t)(unsigned char)p[0] << 16 | (uint32_t)(unsigned char)p[1] << 8 | (uint32_t)(unsigned char)p[2];
+}
+static const size_t kTrigramEntryBytes = sizeof(std::pair<const uint32_t, std::vector<uint32_t>>) + 2 * sizeof(void*);
+static void trigram_add_doc(std::unordered_map<uint32_t, std::vector<uint32_t>> &postings, size_t &bytes, uint32_t doc, const std::string &line) {
+    for (size_t i = 0; i + 3 <= line.size(); ++i) {
+        auto ins = postings.try_emplace(trigram_key(line.data() + i));
+        std::vector<uint32_t> &pl = ins.first->second;
+        if (ins.second) bytes += kTrigramEntryBytes;
+        if (!pl.empty() && pl.back() == doc) continue;
+        size_t cap = pl.capacity();
+        pl.push_back(doc);
+        bytes += (pl.capacity() - cap) * sizeof(uint32_t);
+    }
+}
+// Hook for wal_apply: indexes logs appended since the last call once the index is ready.
+static void trigram_index_on_append() {
+    if (!trigramIndex.ready) return;
+    while (trigramIndex.docCount < dailyLogs.size()) {
+        trigram_add_doc(trigramIndex.postings, trigramIndex.bytes, trigramIndex.docCount, trigram_doc_text(dailyLogs[trigramIndex.docCount]));
+        ++trigramIndex.docCount;
+    }
+}
+static void trigram_index_clear() {
+    trigramIndex.postings.clear();
+    trigramIndex.bytes = 0;
+    trigramIndex.docCount = 0;
+    trigramIndex.ready = true; // nothing left to build
+    trigramIndex.building = false;
+    ++trigramIndex.generation;
+}
+
+// Builds the index for the current logs on the job pool. The logs are copied so the
+// UI thread keeps appending freely; the result is swapped in on the UI thread and
+// anything logged meanwhile is indexed on top.
+static void trigram_index_start() {
+    trigramIndex.building = true;
+    uint64_t gen = trigramIndex.generation;
+    auto docs = std::make_shared<std::vector<DailyLog>>(dailyLogs);
+    jobPool.submit([docs, gen]() {
+        auto built = std::make_shared<std::unordered_map<uint32_t, std::vector<uint32_t>>>();
+        size_t bytes = 0;
+        for (uint32_t i = 0; i < docs->size(); ++i) trigram_add_doc(*built, bytes, i, trigram_doc_text((*docs)[i]));
+        uint32_t count = (uint32_t)docs->size();
+        post_to_ui([built, bytes, count, gen] {
+            if (gen != trigramIndex.generation) return;
+            trigramIndex.postings.swap(*built);
+            trigramIndex.bytes = bytes;
+            trigramIndex.docCount = count;
+            trigramIndex.ready = true;
+            trigramIndex.building = false;
+            trigram_index_on_append();
+        });
+    }, JobPriority::Low);
+}
+
+// Approximate memory held by the index: posting arrays plus hash table overhead.
+static size_t trigram_index_bytes() {
+    return trigramIndex.bytes + trigramIndex.postings.bucket_count() * sizeof(void*);
+}
+
+// Smallest edit distance between `pat` and any substring of `text` (Sellers' algorithm),
+// giving up early once it exceeds maxDist.
+static int approx_substring_distance(const std::string &pat, const std::string &text, int maxDist) {
+    const size_t m = pat.size();
+    std::vector<int> col(m + 1), prev(m + 1);
+    for (size_t i = 0; i <= m; ++i) col[i] = (int)i;
+    int best = col[m];
+    for (size_t j = 0; j < text.size() && best > 0; ++j) {
+        prev.swap(col);
+        col[0] = 0;
+        for (size_t i = 1; i <= m; ++i) {
+            int sub = prev[i - 1] + (pat[i - 1] == text[j] ? 0 : 1);
+            col[i] = std::min(sub, std::min(prev[i] + 1, col[i - 1] + 1));
+        }
+        best = std::min(best, col[m]);
+    }
+    return best <= maxDist ? best : maxDist + 1;
+}
+static int fuzzy_max_distance(size_t len) { return len < 4 ? 0 : (len < 8 ? 1 : 2); }
+
+// Distinct trigrams of a lowercased query.
+static std::vector<uint32_t> trigram_query_grams(const std::string &q) {
+    std::vector<uint32_t> grams;
+    for (size_t i = 0; i + 3 <= q.size(); ++i) grams.push_back(trigram_key(q.data() + i));
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+// Logs containing a 1-2 byte query, newest first. Every line is at least 3 bytes, so
+// each of its bytes (and byte pairs) lies inside one of its trigrams: the union of the
+// postings of the trigrams containing the query is exact.
+static std::vector<uint32_t> search_trigrams_containing(const std::string &q, size_t limit) {
+    std::vector<bool> seen(trigramIndex.docCount);
+    for (const auto &kv : trigramIndex.postings) {
+        char g[3] = { (char)(kv.first >> 16), (char)(kv.first >> 8), (char)kv.first };
+        if (std::search(g, g + 3, q.begin(), q.end()) == g + 3) continue;
+        for (uint32_t doc : kv.second) seen[doc] = true;
+    }
+    std::vector<uint32_t> out;
+    for (uint32_t doc = trigramIndex.docCount; doc-- > 0 && out.size() < limit;) if (seen[doc]) out.push_back(doc);
+    return out;
+}
+
+// Substring (or fuzzy) search; returns matching log indices, newest first. Never scans
+// every log: nothing is found until the index is ready, and a fuzzy query only
+// tolerates as many typos as its trigrams can still filter for.
+static std::vector<uint32_t> search_logs_substring(const std::string &query, bool fuzzy, size_t limit) {
+    std::vector<uint32_t> out;
+    std::string q = to_lower_ascii(query);
+    if (q.empty() || !trigramIndex.ready) return out;
+    if (q.size() < 3) return search_trigrams_containing(q, limit);
+    // Distinct query trigrams; each edit destroys at most 3 of them, which bounds how
+    // many a fuzzy match must still share.
+    std::vector<uint32_t> grams = trigram_query_grams(q);
+    int maxDist = fuzzy ? fuzzy_max_distance(q.size()) : 0;
+    while (maxDist > 0 && (int)grams.size() - 3 * maxDist <= 0) --maxDist;
+    const int needGrams = (int)grams.size() - 3 * maxDist;
+    auto verify = [&](uint32_t doc) {
+        std::string line = trigram_doc_text(dailyLogs[doc]);
+        if (maxDist == 0) return line.find(q) != std::string::npos;
+        return approx_substring_distance(q, line, maxDist) <= maxDist;
+    };
+    std::vector<const std::vector<uint32_t>*> lists;
+    for (uint32_t g : grams) {
+        auto it = trigramIndex.postings.find(g);
+        if (it != trigramIndex.postings.end()) lists.push_back(&it->second);
+        else if (maxDist == 0) return out;
+    }
+    std::vector<uint32_t> candidates;
+    if (maxDist == 0) {
+        std::sort(lists.begin(), lists.end(), [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) { return a->size() < b->size(); });
+        candidates = *lists[0];
+        for (size_t k = 1; k < lists.size() && !candidates.empty(); ++k) {
+            std::vector<uint32_t> next;
+            std::set_intersection(candidates.begin(), candidates.end(), lists[k]->begin(), lists[k]->end(), std::back_inserter(next));
+            candidates.swap(next);
+        }
+    } else {
+        // count shared trigrams per log (postings are deduplicated per log)
+        std::unordered_map<uint32_t, int> hits;
+        for (const auto* pl : lists) for (uint32_t doc : *pl) ++hits[doc];
+        for (const auto &kv : hits) if (kv.second >= needGrams) candidates.push_back(kv.first);
+        std::sort(candidates.begin(), candidates.end());
+    }
+    for (size_t k = candidates.size(); k-- > 0 && out.size() < limit;)
+        if (verify(candidates[k])) out.push_back(candidates[k]);
+    return out;
+}
+
+// ----------------------- Search box ---------------------------------------
+// Search box state: results are recomputed when the query, mode or log count changes.
+enum SearchMode { SearchWords = 0, SearchSubstring, SearchFuzzy };
+static int searchMode = SearchWords;
+static int searchLastMode = SearchWords;
+static char searchQueryText[128] = "";
+static std::string searchLastQuery;
+static size_t searchLastLogCount = 0;
+static std::vector<uint32_t> searchResults;
+static double searchLastMillis = 0.0;
+static const size_t kMaxSearchResults = 100000;
+static bool searchLastIndexReady = false; // substring results wait for the trigram index
+
+static void refresh_search_results() {
+    std::string q(searchQueryText);
+    if (q == searchLastQuery && searchMode == searchLastMode && searchLastLogCount == dailyLogs.size() &&
+        searchLastIndexReady == trigramIndex.ready) return;
+    searchLastQuery = q;
+    searchLastMode = searchMode;
+    searchLastLogCount = dailyLogs.size();
+    searchLastIndexReady = trigramIndex.ready;
+    auto t0 = std::chrono::steady_clock::now();
+    if (searchMode == SearchWords) searchResults = search_logs(q, kMaxSearchResults);
+    else searchResults = search_logs_substring(q, searchMode == SearchFuzzy, kMaxSearchResults);
+    searchLastMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// ----------------------- Storage backends ---------------------------------
+// Logs and tasks are mirrored out of the journal into a storage backend that other
+// tools read. FlatFileBackend writes daily_logs.txt / tasks.txt (the default).
+// SqliteBackend (built when CMake finds SQLite3, selected with PT_STORAGE=sqlite) also
+// keeps them in tracker.db: WAL mode, so ad-hoc queries and other readers work while
+// the app writes, and indexes on ts and (type, ts). It keeps writing the text files as
+// well, since pt_aggregate, analyze_productivity.py and live reload read only those.
+// tracker.db records the offset in daily_logs.txt up to which it holds every line,
+// updated in the transaction that inserts them; on open it imports the lines after
+// it, so logs written while running with files (or while the app was not running)
+// are not lost.
+// begin_batch()/end_batch() group writes into one file append or one transaction;
+// wal_begin_batch()/wal_end_batch() drive them.
+struct StorageBackend {
+    virtual ~StorageBackend() {}
+    virtual const char* name() const = 0;
+    virtual void append_log(time_t ts, const std::string &type, const std::string &text) = 0;
+    // Lines someone else already appended to daily_logs.txt (live reload); every line
+    // before `fileEnd` has now been seen.
+    virtual void import_logs(const std::vector<DailyLog> &, uint64_t /*fileEnd*/) {}
+    virtual void save_tasks(const std::vector<Task> &t) = 0;
+    virtual void begin_batch() = 0;
+    virtual void end_batch() = 0;
+    // Entries with from <= ts < to, in log order.
+    virtual void query_range(time_t from, time_t to, std::vector<DailyLog> &out) = 0;
+};
+
+struct FlatFileBackend : StorageBackend {
+    std::string dir;
+    bool batching = false;
+    std::string pendingLines; // daily_logs.txt lines held back while batching
+    uint64_t lastBegin = 0, lastEnd = 0; // daily_logs.txt range of the latest append
+    explicit FlatFileBackend(const std::string &d) : dir(d) {}
+    ~FlatFileBackend() override { end_batch(); }
+    const char* name() const override { return "files"; }
+    void append_log(time_t ts, const std::string &type, const std::string &text) override {
+        std::string line = human_log_line(type.c_str(), text, ts);
+        line += '\n';
+        if (batching) pendingLines += line;
+        else live_reload_append_own(dir + "/daily_logs.txt", line, lastBegin, lastEnd);
+    }
+    void save_tasks(const std::vector<Task> &t) override {
+        std::ostringstream content;
+        for (size_t i = 0; i < t.size(); ++i) {
+            content << i << ": [" << (t[i].done ? "x" : " ") << "] " << t[i].name;
+            if (t[i].parent != -1) content << " (parent=" << t[i].parent << ")";
+            content << "\n";
+        }
+        live_reload_note_own_tasks(content.str());
+        std::ofstream f(dir + "/tasks.txt");
+        if (!f) return;
+        f << content.str();
+    }
+    void begin_batch() override { batching = true; }
+    void end_batch() override {
+        batching = false;
+        if (pendingLines.empty()) return;
+        live_reload_append_own(dir + "/daily_logs.txt", pendingLines, lastBegin, lastEnd);
+        pendingLines.clear();
+    }
+    void query_range(time_t from, time_t to, std::vector<DailyLog> &out) override {
+        std::ifstream f(dir + "/daily_logs.txt");
+        std::string line;
+        DailyLog d;
+        while (std::getline(f, line)) {
+            if (pt_parse_log_line(line, d.ts, d.type, d.text) && d.ts >= from && d.ts < to) out.push_back(d);
+        }
+    }
+};
+
+#ifdef PT_HAVE_SQLITE
+struct SqliteBackend : StorageBackend {
+    sqlite3* db = nullptr;
+    sqlite3_stmt* insertLog = nullptr;
+    sqlite3_stmt* insertTask = nullptr;
+    sqlite3_stmt* selectRange = nullptr;
+    sqlite3_stmt* setSynced = nullptr;
+    bool batching = false;
+    std::unique_ptr<FlatFileBackend> text; // daily_logs.txt / tasks.txt, kept current for the text readers
+    uint64_t synced = 0;                   // every line of daily_logs.txt before this is in logs
+    ~SqliteBackend() override {
+        if (batching) end_batch();
+        sqlite3_finalize(insertLog);
+        sqlite3_finalize(insertTask);
+        sqlite3_finalize(selectRange);
+        sqlite3_finalize(setSynced);
+        if (db) sqlite3_close(db);
+    }
+    const char* name() const override { return "sqlite"; }
+    bool exec(const char* sql) {
+        char* err = nullptr;
+        if (sqlite3_exec(db, sql, nullptr, nullptr, &err) == SQLITE_OK) return true;
+        fprintf(stderr, "tracker.db: %s (%s)\n", err ? err : sqlite3_errmsg(db), sql);
+        sqlite3_free(err);
+        return false;
+    }
+    bool prepare(const char* sql, sqlite3_stmt** st) {
+        if (sqlite3_prepare_v2(db, sql, -1, st, nullptr) == SQLITE_OK) return true;
+        fprintf(stderr, "tracker.db: %s (%s)\n", sqlite3_errmsg(db), sql);
+        return false;
+    }
+    bool open(const std::string &dir) {
+        std::string path = dir + "/tracker.db";
+        if (sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK) {
+            fprintf(stderr, "%s: %s\n", path.c_str(), db ? sqlite3_errmsg(db) : "cannot open");
+            return false;
+        }
+        sqlite3_busy_timeout(db, 2000);
+        // journal.wal is the source of truth, so the mirror does not need to fsync every commit
+        if (!exec("PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;") ||
+            !exec("CREATE TABLE IF NOT EXISTS logs(id INTEGER PRIMARY KEY, ts INTEGER NOT NULL, type TEXT NOT NULL, text TEXT NOT NULL);"
+                  "CREATE INDEX IF NOT EXISTS logs_ts ON logs(ts);"
+                  "CREATE INDEX IF NOT EXISTS logs_type_ts ON logs(type, ts);"
+                  "CREATE TABLE IF NOT EXISTS tasks(idx INTEGER PRIMARY KEY, name TEXT NOT NULL, parent INTEGER NOT NULL, done INTEGER NOT NULL);"
+                  "CREATE TABLE IF NOT EXISTS meta(key TEXT PRIMARY KEY, value TEXT);") ||
+            !prepare("INSERT INTO logs(ts, type, text) VALUES(?, ?, ?)", &insertLog) ||
+            !prepare("INSERT INTO tasks(idx, name, parent, done) VALUES(?, ?, ?, ?)", &insertTask) ||
+            !prepare("SELECT ts, type, text FROM logs WHERE ts >= ? AND ts < ? ORDER BY ts, id", &selectRange) ||
+            !prepare("INSERT OR REPLACE INTO meta(key, value) VALUES('daily_logs_synced_size', ?)", &setSynced))
+            return false;
+        text.reset(new FlatFileBackend(dir));
+        import_text_files();
+        return true;
+    }
+    uint64_t daily_logs_size() const {
+        struct stat st;
+        return stat((text->dir + "/daily_logs.txt").c_str(), &st) == 0 ? (uint64_t)st.st_size : 0;
+    }
+    int64_t meta_int(const char* key) {
+        sqlite3_stmt* st = nullptr;
+        int64_t v = -1;
+        if (prepare("SELECT value FROM meta WHERE key = ?", &st)) {
+            sqlite3_bind_text(st, 1, key, -1, SQLITE_STATIC);
+            if (sqlite3_step(st) == SQLITE_ROW) v = sqlite3_column_int64(st, 0);
+        }
+        sqlite3_finalize(st);
+        return v;
+    }
+    // Stored in the transaction that inserted the lines, so the database and its
+    // offset never disagree.
+    void save_synced() {
+        sqlite3_bind_int64(setSynced, 1, (sqlite3_int64)synced);
+        if (sqlite3_step(setSynced) != SQLITE_DONE) fprintf(stderr, "tracker.db: %s\n", sqlite3_errmsg(db));
+        sqlite3_reset(setSynced);
+    }
+    // After our own append: it extends the synced prefix unless someone else's lines
+    // sit in between and live reload is about to import them. Without live reload
+    // such lines are not journaled either, and are skipped here too.
+    void note_own_append() {
+        if (text->lastEnd <= synced || (text->lastBegin != synced && live_reload_running())) return;
+        synced = text->lastEnd;
+        save_synced();
+    }
+    // Imports the lines appended to daily_logs.txt since tracker.db last saw the file:
+    // by the app while running with files, or by anyone while it was not running.
+    // If the file no longer fits the recorded offset (rewritten or truncated) the logs
+    // table is rebuilt from it. A database from before the offset was kept is taken to
+    // be in sync. tasks.txt is reloaded either way.
+    void import_text_files() {
+        uint64_t size = daily_logs_size();
+        int64_t from = meta_int("daily_logs_synced_size");
+        if (from < 0 && meta_int("flat_files_imported") >= 0) from = (int64_t)size;
+        std::string line;
+        begin_batch();
+        std::ifstream lf(text->dir + "/daily_logs.txt", std::ios::binary);
+        bool rebuild = from < 0 || (uint64_t)from > size;
+        if (!rebuild && from > 0 && lf) {
+            lf.seekg(from - 1);
+            rebuild = lf.get() != '\n';
+        }
+        if (rebuild) {
+            if (from > 0) fprintf(stderr, "tracker.db: daily_logs.txt was rewritten; rebuilding the logs table from it\n");
+            exec("DELETE FROM logs");
+            from = 0;
+            lf.clear();
+            lf.seekg(0);
+        }
+        synced = (uint64_t)from;
+        size_t n = 0;
+        DailyLog d;
+        while (std::getline(lf, line)) {
+            if (lf.eof()) break; // no newline yet: a line still being written
+            synced += line.size() + 1;
+            if (pt_parse_log_line(line, d.ts, d.type, d.text)) { insert_log(d.ts, d.type, d.text); ++n; }
+        }
+        save_synced();
+        std::ifstream tf(text->dir + "/tasks.txt");
+        if (tf) {
+            std::vector<Task> t;
+            Task task;
+            while (std::getline(tf, line)) {
+                if (pt_parse_task_line(line, task.name, task.parent, task.done)) t.push_back(task);
+            }
+            save_db_tasks(t);
+        }
+        end_batch();
+        if (n) fprintf(stderr, "tracker.db: imported %zu lines from daily_logs.txt\n", n);
+    }
+    void append_log(time_t ts, const std::string &type, const std::string &t) override {
+        if (!batching) exec("BEGIN");
+        insert_log(ts, type, t);
+        text->append_log(ts, type, t);
+        if (!batching) { note_own_append(); exec("COMMIT"); }
+    }
+    void import_logs(const std::vector<DailyLog> &logs, uint64_t fileEnd) override {
+        if (!batching) exec("BEGIN");
+        for (const auto &d : logs) insert_log(d.ts, d.type, d.text);
+        // Lines before fileEnd are either these or the app's own, inserted when written
+        if (fileEnd > synced) { synced = fileEnd; save_synced(); }
+        if (!batching) exec("COMMIT");
+    }
+    void insert_log(time_t ts, const std::string &type, const std::string &text) {
+        sqlite3_bind_int64(insertLog, 1, (sqlite3_int64)ts);
+        sqlite3_bind_text(insertLog, 2, type.data(), (int)type.size(), SQLITE_STATIC);
+        sqlite3_bind_text(insertLog, 3, text.data(), (int)text.size(), SQLITE_STATIC);
+        if (sqlite3_step(insertLog) != SQLITE_DONE) fprintf(stderr, "tracker.db: insert failed: %s\n", sqlite3_errmsg(db));
+        sqlite3_reset(insertLog);
+    }
+    void save_tasks(const std::vector<Task> &t) override {
+        text->save_tasks(t);
+        save_db_tasks(t);
+    }
+    void save_db_tasks(const std::vector<Task> &t) {
+        if (!batching) exec("BEGIN");
+        exec("DELETE FROM tasks");
+        for (size_t i = 0; i < t.size(); ++i) {
+            sqlite3_bind_int64(insertTask, 1, (sqlite3_int64)i);
+            sqlite3_bind_text(insertTask, 2, t[i].name.data(), (int)t[i].name.size(), SQLITE_STATIC);
+            sqlite3_bind_int(insertTask, 3, t[i].parent);
+            sqlite3_bind_int(insertTask, 4, t[i].done ? 1 : 0);
+            if (sqlite3_step(insertTask) != SQLITE_DONE) fprintf(stderr, "tracker.db: task insert failed: %s\n", sqlite3_errmsg(db));
+            sqlite3_reset(insertTask);
+        }
+        if (!batching) exec("COMMIT");
+    }
+    void begin_batch() override {
+        text->begin_batch();
+        if (!batching) batching = exec("BEGIN");
+    }
+    void end_batch() override {
+        uint64_t before = text->lastEnd;
+        text->end_batch();
+        if (!batching) return;
+        if (text->lastEnd != before) note_own_append();
+        exec("COMMIT");
+        batching = false;
+    }
+    void query_range(time_t from, time_t to, std::vector<DailyLog> &out) override {
+        sqlite3_bind_int64(selectRange, 1, (sqlite3_int64)from);
+        sqlite3_bind_int64(selectRange, 2, (sqlite3_int64)to);
+        DailyLog d;
+        while (sqlite3_step(selectRange) == SQLITE_ROW) {
+            d.ts = (time_t)sqlite3_column_int64(selectRange, 0);
+            d.type.assign((const char*)sqlite3_column_text(selectRange, 1), (size_t)sqlite3_column_bytes(selectRange, 1));
+            d.text.assign((const char*)sqlite3_column_text(selectRange, 2), (size_t)sqlite3_column_bytes(selectRange, 2));
+            out.push_back(d);
+        }
+        sqlite3_reset(selectRange);
+    }
+};
+#endif
+
+// Backend by name ("files" or "sqlite"); falls back to files when sqlite is not
+// built in or the database cannot be opened.
+static std::unique_ptr<StorageBackend> storage_create(const std::string &kind, const std::string &dir) {
+    if (kind == "sqlite") {
+#ifdef PT_HAVE_SQLITE
+        std::unique_ptr<SqliteBackend> db(new SqliteBackend());
+        if (db->open(dir)) return std::unique_ptr<StorageBackend>(db.release());
+        fprintf(stderr, "storage: falling back to daily_logs.txt/tasks.txt\n");
+#else
+        fprintf(stderr, "storage: built without SQLite, using daily_logs.txt/tasks.txt\n");
+#endif
+    }
+    return std::unique_ptr<StorageBackend>(new FlatFileBackend(dir));
+}
+
+static std::unique_ptr<StorageBackend> storage;
+// Startup (primary only): opening tracker.db may import daily_logs.txt, which must
+// not happen on the first log written from the UI.
+static void storage_open() {
+    const char* kind = getenv("PT_STORAGE");
+    std::string dir = user_data_dir();
+    ensure_dir_exists(dir);
+    storage = storage_create(kind ? kind : "files", dir);
+}
+static StorageBackend &storage_backend() {
+    if (!storage) storage_open();
+    return *storage;
+}
+static void storage_begin_batch() { storage_backend().begin_batch(); }
+static void storage_end_batch() { storage_backend().end_batch(); }
+static void storage_close() { storage.reset(); }
+
+// ----------------------- Persistence & data --------------------------------
+static void append_daily_log(const char* type, const std::string &text) {
+    if (instance_forward(std::string("LOG_AS ") + type + " " + ipc_escape(text))) return;
+    WalRecord r; r.op = WalOp::Log; r.ts = (int64_t)time(nullptr); r.s1 = type; r.s2 = text;
+    wal_commit(r);
+    storage_backend().append_log((time_t)r.ts, r.s1, r.s2);
+}
+static void save_tasks() {
+    if (instance_is_secondary()) return; // the primary owns tasks.txt
+    if (wal_batch_depth > 0) { wal_batch_tasks_dirty = true; return; }
+    storage_backend().save_tasks(tasks);
+}
+static void save_daily_status_to_disk_and_log(const std::string &text) {
+    if (instance_forward("DAILY_STATUS " + ipc_escape(text))) return;
+    append_line_to_file(path_in_data("daily_status.txt"), human_log_line("DAILY_STATUS", text));
+    append_daily_log("DAILY_STATUS", text);
+    std::string p = export_text_to_file("daily_status_saved", text.c_str());
+    if (!p.empty()) append_daily_log("EXPORT", std::string("Exported daily status to ") + p);
+}
+static void save_weekly_status_to_disk_and_log(const std::string &text) {
+    if (instance_forward("WEEKLY_STATUS " + ipc_escape(text))) return;
+    append_line_to_file(path_in_data("weekly_status.txt"), human_log_line("WEEKLY_STATUS", text));
+    append_daily_log("WEEKLY_STATUS", text);
+    std::string p = export_text_to_file("weekly_status_saved", text.c_str());
+    if (!p.empty()) append_daily_log("EXPORT", std::string("Exported weekly status to ") + p);
+}
+static void load_tasks() {
+    tasks.clear();
+    ++tasks_version;
+    std::ifstream f(path_in_data("tasks.txt"));
+    if (!f) return;
+    std::string line;
+    Task t;
+    while (std::getline(f, line)) {
+        if (pt_parse_task_line(line, t.name, t.parent, t.done)) tasks.push_back(t);
+    }
+}
+static void load_daily_logs() {
+    dailyLogs.clear();
+    std::ifstream f(path_in_data("daily_logs.txt"));
+    if (!f) return;
+    std::string line;
+    DailyLog d;
+    while (std::getline(f, line)) {
+        if (pt_parse_log_line(line, d.ts, d.type, d.text)) dailyLogs.push_back(d);
+    }
+}
+
+// Reconstructs break history from BREAK_* lines in daily_logs.txt. Only used when
+// migrating a data directory that predates the journal; breaks left open by an
+// old session are closed at the last logged timestamp.
+static void rebuild_breaks_from_logs() {
+    breaks.clear();
+    rebuild_active_break_index();
+    auto strip_suffix = [](const std::string &s) {
+        size_t p = s.rfind(" (");
+        return (p == std::string::npos) ? s : s.substr(0, p);
+    };
+    for (const auto &d : dailyLogs) {
+        if (d.type == "BREAK_START" && d.text.rfind("Started break: ", 0) == 0) {
+            BreakEntry b; b.type = d.text.substr(15); b.start = d.ts; b.end = 0;
+            breaks.push_back(b);
+            index_break_started((int)breaks.size() - 1);
+        } else if (d.type == "BREAK_END" && d.text.rfind("Ended break: ", 0) == 0) {
+            int idx = last_active_break_of_type(strip_suffix(d.text.substr(13)));
+            if (idx >= 0) { breaks[idx].end = d.ts; index_break_ended(idx); }
+        } else if (d.type == "BREAK_RANDOM" && d.text.rfind("Random break: ", 0) == 0) {
+            std::string rest = d.text.substr(14);
+            size_t open = rest.rfind(" (");
+            size_t sep = (open == std::string::npos) ? std::string::npos : rest.find(" - ", open);
+            if (sep == std::string::npos) continue;
+            BreakEntry b; b.type = rest.substr(0, open);
+            b.start = parse_timestamp(rest.substr(open + 2, sep - (open + 2)));
+            b.end = parse_timestamp(rest.substr(sep + 3));
+            breaks.push_back(b);
+        }
+    }
+    time_t last = dailyLogs.empty() ? time(nullptr) : dailyLogs.back().ts;
+    for (auto &b : breaks) if (b.end == 0) b.end = last;
+    rebuild_active_break_index();
+}
+
+static void wal_end_batch() {
+    if (wal_batch_depth == 0 || --wal_batch_depth > 0) return;
+    if (wal_batch_unsynced && wal_file) wal_sync_file(wal_file);
+    wal_batch_unsynced = false;
+    if (wal_batch_tasks_dirty) {
+        wal_batch_tasks_dirty = false;
+        save_tasks();
+    }
+    storage_end_batch();
+}
+
+// ---------------- Breaks/tasks helper definitions -------------------------
+// Forwarded commands that name a task or break by index carry what the secondary saw
+// there; its view can lag the primary's, so the primary refuses them if it differs.
+static std::string ipc_task_precondition(int idx) {
+    return " " + std::to_string(tasks[idx].parent) + " " + ipc_escape(tasks[idx].name);
+}
+static void end_break_at(int idx, time_t end) {
+    if (instance_forward("BREAK_END_AT " + std::to_string(idx) + " " + std::to_string((long long)breaks[idx].start))) return;
+    WalRecord r; r.op = WalOp::BreakEnd; r.index = idx; r.ts = (int64_t)end;
+    wal_commit(r);
+}
+static void start_break(const std::string &type) {
+    if (instance_forward("BREAK_START " + type)) return;
+    bool was_active = (active_breaks_count() > 0);
+
+    WalRecord r; r.op = WalOp::BreakStart; r.s1 = type; r.ts = (int64_t)time(nullptr); r.ts2 = 0;
+    wal_commit(r);
+    append_daily_log("BREAK_START", std::string("Started break: ") + type);
+
+    // If this is the first active break, pause the session tracking
+    if (!was_active) {
+        if (tracking_start_time != 0) {
+            wal_commit_op(WalOp::TimerPause, time(nullptr));
+            append_daily_log("TIMER", std::string("Paused session timer (break started)"));
+        }
+    }
+}
+static void end_last_break_of_type(const std::string &type) {
+    if (instance_forward("BREAK_END " + type)) return;
+    int idx = last_active_break_of_type(type);
+    if (idx < 0) {
+        append_daily_log("BREAK_WARN", std::string("Tried to end break but none active: ") + type);
+        return;
+    }
+    end_break_at(idx, time(nullptr));
+    const BreakEntry &b = breaks[idx];
+    std::ostringstream oss;
+    oss << "Ended break: " << b.type << " (start " << format_time_local(b.start)
+        << ", end " << format_time_local(b.end) << ")";
+    append_daily_log("BREAK_END", oss.str());
+
+    // If there are no more active breaks after ending this one, resume the session tracking
+    if (active_breaks_count() == 0) {
+        wal_commit_op(WalOp::TimerResume, time(nullptr));
+        append_daily_log("TIMER", std::string("Resumed session timer (break ended)"));
+    }
+}
+static void add_random_break() {
+    if (instance_forward("BREAK_RANDOM")) return;
+    std::uniform_int_distribution<int> dtype(0, (int)kBreakTypes.size()-1);
+    std::uniform_int_distribution<int> dmin(1, 20);
+    std::string t = kBreakTypes[dtype(rng)];
+    BreakEntry b; b.type = t; b.start = time(nullptr) - dmin(rng)*60; b.end = time(nullptr);
+    WalRecord r; r.op = WalOp::BreakStart; r.s1 = b.type; r.ts = (int64_t)b.start; r.ts2 = (int64_t)b.end;
+    wal_commit(r);
+    std::ostringstream oss; oss << "Random break: " << b.type << " (" << format_time_local(b.start) << " - " << format_time_local(b.end) << ")";
+    append_daily_log("BREAK_RANDOM", oss.str());
+}
+static void add_task(const std::string &name, int parent_idx) {
+    if (instance_forward("TASK_ADD " + std::to_string(parent_idx) + " " + ipc_escape(name))) return;
+    WalRecord r; r.op = WalOp::TaskAdd; r.s1 = name; r.index = parent_idx;
+    wal_commit(r);
+    save_tasks();
+    append_daily_log("TASK", std::string("Added task: ") + name);
+}
+static void set_task_done(int idx, bool done) {
+    if (instance_forward("TASK_DONE " + std::to_string(idx) + (done ? " 1" : " 0") + ipc_task_precondition(idx))) return;
+    WalRecord r; r.op = WalOp::TaskDone; r.index = idx; r.flag = done ? 1 : 0; r.ts = (int64_t)time(nullptr);
+    wal_commit(r);
+    save_tasks();
+    append_daily_log("TASK", std::string("Toggled task: ") + tasks[idx].name + (done ? " [done]" : " [not done]"));
+}
+
+static void clearAllData()
+{
+    // Clear in-memory structures and reset timers (journaled so a restart does not resurrect them)
+    wal_commit_op(WalOp::Clear, time(nullptr));
+    wal_write_snapshot(true);
+}
+
+static std::atomic<bool> request_quit(false);
+
+static void end_day_action() {
+    time_t now = time(nullptr);
+    // One journal fsync and one storage transaction for the whole burst
+    wal_begin_batch();
+    // End any active breaks (in start order, straight from the active index)
+    std::vector<int> active;
+    active.reserve(active_breaks_count());
+    for (const auto &kv : active_breaks_by_type) active.insert(active.end(), kv.second.begin(), kv.second.end());
+    std::sort(active.begin(), active.end());
+    for (int i : active) {
+        end_break_at(i, now);
+        const BreakEntry &b = breaks[i];
+        std::ostringstream oss; oss << "Ended break: " << b.type << " (start " << format_time_local(b.start) << ", end " << format_time_local(b.end) << ")";
+        append_daily_log("BREAK_END", oss.str());
+    }
+
+    // Pause tracking if running and accumulate
+    if (tracking_start_time != 0) {
+        wal_commit_op(WalOp::TimerPause, now);
+        append_daily_log("TIMER", std::string("Paused session timer (end of day)"));
+    }
+
+    long total_tracked = accumulated_tracked_seconds;
+    std::string total_s = format_duration_seconds(total_tracked);
+    append_daily_log("END_DAY", std::string("End of day. Total tracked: ") + total_s);
+
+    // Export hourly logs (today) and weekly logs; both finish on the job pool
+    export_hourly_logs_today();
+    export_weekly_logs_file();
+
+    // Save inline daily/weekly status if present
+    if (std::strlen(dailyStatusText) > 0) {
+        std::string pd = export_text_to_file("daily_status_end_of_day", dailyStatusText);
+        if (!pd.empty()) append_daily_log("EXPORT", std::string("Exported daily status to ") + pd);
+    }
+    if (std::strlen(weeklyStatusText) > 0) {
+        std::string pw = export_text_to_file("weekly_status_end_of_day", weeklyStatusText);
+        if (!pw.empty()) append_daily_log("EXPORT", std::string("Exported weekly status to ") + pw);
+    }
+
+    // Save tasks
+    save_tasks();
+
+    // Reset timers for next day/session
+    wal_commit_op(WalOp::TimerReset, time(nullptr));
+    wal_end_batch();
+
+    // Request app quit after finishing end-of-day work
+    request_quit.store(true);
+}
+
+// ----------------------- Local IPC endpoint -------------------------------
+// The running tracker listens on tracker.sock (a Unix domain socket in the data dir,
+// mode 0600) so editors, git hooks and shell prompts can log without the UI.
+// Protocol: one command per '\n'-terminated line, one reply line per command,
+// "OK[ <data>]" or "ERR <reason>". In text arguments "\n" and "\\" are escapes.
+//   LOG <text>                    HOURLY entry
+//   LOG_AS <TYPE> <text>          entry of another type
+//   TASK_ADD <parent|-1> <name>
+//   TASK_TOGGLE <index> / TASK_DONE <index> <0|1> / TASK_REMOVE <index> (and its children)
+//   BREAK_START <type> / BREAK_END <type> / BREAK_END_AT <index> / BREAK_RANDOM
+//   DAILY_STATUS <text> / WEEKLY_STATUS <text>
+//   TIMER                         -> OK tracked=<s> running=<0|1> breaks=<n> session_start=<unix>
+//   PING                          -> OK pong
+// Everything runs on the UI thread from ipc_poll(), once per frame, with non-blocking
+// sockets. All commands read in one poll share a WAL batch (one fsync), and replies
+// are only sent after that batch is durable.
+static const char* IPC_SOCKET_FILE = "tracker.sock";
+static const size_t kIpcMaxLine = 64 * 1024;
+static const size_t kIpcMaxCommandsPerPoll = 20000;
+static const size_t kIpcMaxPendingOut = 1 << 20;
+
+#ifndef _WIN32
+struct IpcClient {
+    int fd = -1;
+    std::string in;
+    std::string out;
+    bool eof = false;
+};
+static int ipcListenFd = -1;
+static std::string ipcSocketPath;
+static std::vector<IpcClient> ipcClients;
+
+static void set_nonblocking_cloexec(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+static void ipc_start() {
+    ipcSocketPath = path_in_data(IPC_SOCKET_FILE);
+    struct sockaddr_un addr{};
+    if (ipcSocketPath.size() >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "ipc: socket path too long: %s\n", ipcSocketPath.c_str());
+        return;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, ipcSocketPath.c_str(), ipcSocketPath.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) { perror("ipc: socket"); return; }
+    // A socket file that still accepts connections belongs to another running tracker
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+        fprintf(stderr, "ipc: %s is in use by another instance; IPC disabled\n", ipcSocketPath.c_str());
+        close(fd);
+        return;
+    }
+    close(fd);
+    unlink(ipcSocketPath.c_str());
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) { perror("ipc: socket"); return; }
+    mode_t old = umask(0177);
+    int rc = bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+    umask(old);
+    if (rc != 0 || listen(fd, 64) != 0) {
+        perror("ipc: bind/listen");
+        close(fd);
+        return;
+    }
+    set_nonblocking_cloexec(fd);
+    ipcListenFd = fd;
+}
+
+static void ipc_stop() {
+    for (auto &c : ipcClients) close(c.fd);
+    ipcClients.clear();
+    if (ipcListenFd >= 0) {
+        close(ipcListenFd);
+        ipcListenFd = -1;
+        unlink(ipcSocketPath.c_str());
+    }
+}
+
+// Texts end up as one line of daily_logs.txt / tasks.txt, so "\n" and other control
+// characters become spaces; a raw newline would split the record.
+static std::string ipc_unescape(const std::string &s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        char c = s[i];
+        if (c == '\\' && i + 1 < s.size()) {
+            c = s[++i];
+            if (c == 'n') c = ' ';
+        }
+        out += ((unsigned char)c < 0x20 || c == 0x7f) ? ' ' : c;
+    }
+    return out;
+}
+static bool ipc_has_control_chars(const std::string &s) {
+    for (char c : s) if ((unsigned char)c < 0x20 || c == 0x7f) return true;
+    return false;
+}
+
+static std::string ipc_escape(const std::string &s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+    return out;
+}
+
+// Splits "VERB rest" and runs it; returns the reply line (without '\n').
+static std::string ipc_handle_command(const std::string &line) {
+    size_t sp = line.find(' ');
+    std::string verb = line.substr(0, sp);
+    std::string rest = (sp == std::string::npos) ? std::string() : line.substr(sp + 1);
+    auto split_first = [](const std::string &s, std::string &head, std::string &tail) {
+        size_t p = s.find(' ');
+        if (p == std::string::npos || p == 0) return false;
+        head = s.substr(0, p);
+        tail = s.substr(p + 1);
+        return !tail.empty();
+    };
+
+    if (verb == "PING") return "OK pong";
+    if (verb == "LOG") {
+        if (rest.empty()) return "ERR empty text";
+        append_daily_log("HOURLY", ipc_unescape(rest));
+        return "OK";
+    }
+    if (verb == "LOG_AS") {
+        std::string type, text;
+        if (!split_first(rest, type, text)) return "ERR usage: LOG_AS <TYPE> <text>";
+        if (ipc_has_control_chars(type)) return "ERR bad type";
+        append_daily_log(type.c_str(), ipc_unescape(text));
+        return "OK";
+    }
+    if (verb == "TASK_ADD") {
+        std::string parent, name;
+        if (!split_first(rest, parent, name)) return "ERR usage: TASK_ADD <parent|-1> <name>";
+        int p = atoi(parent.c_str());
+        if (p < -1 || p >= (int)tasks.size()) return "ERR no such parent";
+        add_task(ipc_unescape(name), p);
+        return "OK " + std::to_string(tasks.size() - 1);
+    }
+    if (verb == "TASK_TOGGLE") {
+        if (rest.empty()) return "ERR usage: TASK_TOGGLE <index>";
+        int idx = atoi(rest.c_str());
+        if (idx < 0 || idx >= (int)tasks.size()) return "ERR no such task";
+        set_task_done(idx, !tasks[idx].done);
+        return tasks[idx].done ? "OK done" : "OK not_done";
+    }
+    // Optional "<parent> <name>" after a task index: refused unless the task still matches
+    auto task_matches = [](int idx, const std::string &expect) {
+        if (expect.empty()) return true;
+        size_t p = expect.find(' ');
+        if (p == std::string::npos) return false;
+        return atoi(expect.substr(0, p).c_str()) == tasks[idx].parent && ipc_unescape(expect.substr(p + 1)) == tasks[idx].name;
+    };
+    if (verb == "TASK_DONE") {
+        std::string index, flag, expect;
+        if (!split_first(rest, index, flag)) return "ERR usage: TASK_DONE <index> <0|1> [<parent> <name>]";
+        split_first(std::string(flag), flag, expect);
+        if (flag != "0" && flag != "1") return "ERR usage: TASK_DONE <index> <0|1> [<parent> <name>]";
+        int idx = atoi(index.c_str());
+        if (idx < 0 || idx >= (int)tasks.size()) return "ERR no such task";
+        if (!task_matches(idx, expect)) return "ERR task changed";
+        if (tasks[idx].done != (flag == "1")) set_task_done(idx, flag == "1");
+        return "OK";
+    }
+    if (verb == "TASK_REMOVE") {
+        std::string index = rest, expect;
+        if (rest.empty()) return "ERR usage: TASK_REMOVE <index> [<parent> <name>]";
+        split_first(rest, index, expect);
+        int idx = atoi(index.c_str());
+        if (idx < 0 || idx >= (int)tasks.size()) return "ERR no such task";
+        if (!task_matches(idx, expect)) return "ERR task changed";
+        removeTaskAndChildren(idx);
+        return "OK";
+    }
+    if (verb == "BREAK_START") {
+        if (rest.empty()) return "ERR usage: BREAK_START <type>";
+        if (ipc_has_control_chars(rest)) return "ERR bad type";
+        start_break(rest);
+        return "OK";
+    }
+    if (verb == "BREAK_END") {
+        if (rest.empty()) return "ERR usage: BREAK_END <type>";
+        if (last_active_break_of_type(rest) < 0) return "ERR no active break of that type";
+        end_last_break_of_type(rest);
+        return "OK";
+    }
+    if (verb == "BREAK_END_AT") {
+        std::string index = rest, start;
+        if (rest.empty()) return "ERR usage: BREAK_END_AT <index> [<start unix time>]";
+        split_first(rest, index, start);
+        int idx = atoi(index.c_str());
+        if (idx < 0 || idx >= (int)breaks.size() || breaks[idx].end != 0) return "ERR no such active break";
+        if (!start.empty() && atoll(start.c_str()) != (long long)breaks[idx].start) return "ERR break changed";
+        end_break_at(idx, time(nullptr));
+        return "OK";
+    }
+    if (verb == "BREAK_RANDOM") {
+        add_random_break();
+        return "OK";
+    }
+    if (verb == "DAILY_STATUS" || verb == "WEEKLY_STATUS") {
+        if (rest.empty()) return "ERR empty text";
+        if (verb == "DAILY_STATUS") save_daily_status_to_disk_and_log(ipc_unescape(rest));
+        else save_weekly_status_to_disk_and_log(ipc_unescape(rest));
+        return "OK";
+    }
+    if (verb == "TIMER") {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "OK tracked=%ld running=%d breaks=%d session_start=%lld",
+                 tracked_seconds_at(time(nullptr)), tracking_start_time != 0 ? 1 : 0,
+                 (int)active_breaks_count(), (long long)app_start_time);
+        return buf;
+    }
+    return "ERR unknown command";
+}
+
+static void ipc_flush(IpcClient &c) {
+    while (!c.out.empty()) {
+#ifdef MSG_NOSIGNAL
+        ssize_t n = send(c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+#else
+        ssize_t n = send(c.fd, c.out.data(), c.out.size(), 0);
+#endif
+        if (n > 0) { c.out.erase(0, (size_t)n); continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        c.eof = true; // peer gone
+        c.out.clear();
+        return;
+    }
+}
+
+// Called once per frame on the UI thread.
+static void ipc_poll() {
+    if (ipcListenFd < 0) return;
+    for (;;) {
+        int fd = accept(ipcListenFd, nullptr, nullptr);
+        if (fd < 0) break;
+        set_nonblocking_cloexec(fd);
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        IpcClient c;
+        c.fd = fd;
+        ipcClients.push_back(std::move(c));
+    }
+    if (ipcClients.empty()) return;
+
+    char buf[16384];
+    size_t budget = kIpcMaxCommandsPerPoll;
+    bool batched = false;
+    for (auto &c : ipcClients) {
+        // Read what is available, but leave unparsed data queued once it exceeds a line
+        while (!c.eof && c.in.size() < kIpcMaxLine * 4) {
+            ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+            if (n > 0) { c.in.append(buf, (size_t)n); continue; }
+            if (n == 0) { c.eof = true; break; }
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) c.eof = true;
+            break;
+        }
+        size_t start = 0;
+        for (;;) {
+            if (budget == 0) break;
+            size_t nl = c.in.find('\n', start);
+            if (nl == std::string::npos) {
+                if (c.in.size() - start > kIpcMaxLine) { c.out += "ERR line too long\n"; c.eof = true; start = c.in.size(); }
+                break;
+            }
+            std::string line = c.in.substr(start, nl - start);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            start = nl + 1;
+            if (line.empty()) continue;
+            if (!batched) { wal_begin_batch(); batched = true; }
+            c.out += ipc_handle_command(line);
+            c.out += '\n';
+            --budget;
+        }
+        c.in.erase(0, start);
+    }
+    // Make the batch durable before anyone is told "OK"
+    if (batched) wal_end_batch();
+    for (auto &c : ipcClients) {
+        ipc_flush(c);
+        if (c.out.size() > kIpcMaxPendingOut) c.eof = true; // not reading its replies
+    }
+    ipcClients.erase(std::remove_if(ipcClients.begin(), ipcClients.end(), [](IpcClient &c) {
+        bool done = c.eof && (c.out.empty() || c.out.size() > kIpcMaxPendingOut) && c.in.find('\n') == std::string::npos;
+        if (done) close(c.fd);
+        return done;
+    }), ipcClients.end());
+}
+#else
+static void ipc_start() {}
+static void ipc_stop() {}
+static void ipc_poll() {}
+#endif
+
+// ----------------------- Single instance ----------------------------------
+// One process writes a data directory: the primary holds an exclusive flock() on
+// tracker.lock (which also records its pid) until it exits. A second instance on the
+// same directory (login scripts, a relaunch after a crash) becomes a secondary window:
+//  - it loads state.snap + journal.wal without writing anything and follows the
+//    journal the primary appends to (after every IPC reply and every 250 ms);
+//  - the mutating helpers call instance_forward() first, which sends their change to
+//    the primary as an IPC command on tracker.sock; it shows up once the primary has
+//    journaled it. If the primary cannot be reached the window is read-only;
+//  - once the primary exits it takes the lock over and continues as the primary.
+// Windows builds always run as the primary.
+static const char* INSTANCE_LOCK_FILE = "tracker.lock";
+
+#ifndef _WIN32
+static const std::chrono::milliseconds kInstanceFollowInterval(250);
+static const std::chrono::milliseconds kInstanceRetryInterval(1000);
+
+// Reader side of journal.wal for a secondary instance. Records up to wal_next_seq - 1
+// are applied; `pending` holds the bytes of a frame the primary is still writing.
+struct JournalFollower {
+    int fd = -1;
+    dev_t dev = 0;
+    ino_t ino = 0;
+    uint64_t offset = 0;
+    std::string pending;
+    bool needReload = true;
+};
+
+static int instanceLockFd = -1;
+static bool instanceSecondary = false;
+static int instancePrimaryPid = 0;
+static IpcClient instancePrimary; // connection to the primary's tracker.sock
+static JournalFollower walFollower;
+static std::chrono::steady_clock::time_point instanceNextFollow, instanceNextRetry;
+
+static bool instance_is_secondary() { return instanceSecondary; }
+
+// Takes the data directory lock; false if another process holds it.
+static bool instance_try_lock() {
+    if (instanceLockFd < 0) {
+        instanceLockFd = open(path_in_data(INSTANCE_LOCK_FILE).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (instanceLockFd < 0) { perror("instance: open tracker.lock"); return true; }
+    }
+    if (flock(instanceLockFd, LOCK_EX | LOCK_NB) != 0) {
+        if (errno != EWOULDBLOCK) { perror("instance: flock (running unlocked)"); return true; }
+        char buf[32] = {};
+        ssize_t n = pread(instanceLockFd, buf, sizeof(buf) - 1, 0);
+        instancePrimaryPid = n > 0 ? atoi(buf) : 0;
+        return false;
+    }
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%d\n", (int)getpid());
+    if (ftruncate(instanceLockFd, 0) != 0 || pwrite(instanceLockFd, buf, (size_t)len, 0) != len) perror("instance: write pid");
+    return true;
+}
+
+static void instance_connect_primary() {
+    std::string path = path_in_data(IPC_SOCKET_FILE);
+    struct sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return;
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) { close(fd); return; }
+    set_nonblocking_cloexec(fd);
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    instancePrimary = IpcClient();
+    instancePrimary.fd = fd;
+}
+
+static bool instance_forward(const std::string &command) {
+    if (!instanceSecondary) return false;
+    if (instancePrimary.fd < 0) {
+        fprintf(stderr, "secondary instance: primary not reachable, not sent: %s\n", command.c_str());
+        return true;
+    }
+    instancePrimary.out += command;
+    instancePrimary.out += '\n';
+    ipc_flush(instancePrimary);
+    return true;
+}
+
+// Loads state.snap in place of the current state; the journal is then re-read from its
+// start. False while there is no snapshot yet (the primary writes one when it starts).
+static bool wal_follow_reload() {
+    uint64_t snapSeq = 0;
+    if (!wal_load_snapshot(snapSeq)) return false;
+    if (!agg_load(snapSeq)) agg_rebuild_from_state();
+    wal_next_seq = snapSeq + 1;
+    new_task_parent_idx = -1;
+    // Logs were replaced, not appended: rebuild the search indexes that are already up
+    search_index_clear();
+    search_index_on_append();
+    if (trigramIndex.ready || trigramIndex.building) {
+        trigram_index_clear();
+        trigramIndex.ready = false;
+        trigram_index_start();
+    }
+    if (walFollower.fd >= 0) close(walFollower.fd);
+    walFollower.fd = -1;
+    walFollower.offset = 0;
+    walFollower.pending.clear();
+    return true;
+}
+
+// Applies the records appended to the open journal since the last call.
+static void wal_follow_read() {
+    struct stat st;
+    if (walFollower.fd < 0 || fstat(walFollower.fd, &st) != 0) return;
+    if ((uint64_t)st.st_size < walFollower.offset) { walFollower.needReload = true; return; } // torn tail cut off
+    char buf[64 * 1024];
+    while (walFollower.offset < (uint64_t)st.st_size) {
+        ssize_t n = pread(walFollower.fd, buf, sizeof(buf), (off_t)walFollower.offset);
+        if (n <= 0) break;
+        walFollower.offset += (uint64_t)n;
+        walFollower.pending.append(buf, (size_t)n);
+    }
+    size_t off = 0;
+    WalRecord r;
+    while (decode_wal_record(walFollower.pending, off, r)) {
+        if (r.seq < wal_next_seq) continue; // already in the snapshot
+        if (r.seq > wal_next_seq) { walFollower.needReload = true; return; } // compacted away before we read it
+        wal_apply(r);
+        wal_next_seq = r.seq + 1;
+    }
+    walFollower.pending.erase(0, off);
+}
+
+static void wal_follow_poll() {
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        if (walFollower.needReload) {
+            if (!wal_follow_reload()) return;
+            walFollower.needReload = false;
+        }
+        // Drain the file that is open first: after a compaction it still holds every
+        // record up to the cut. Then move on to the journal that replaced it.
+        wal_follow_read();
+        struct stat st;
+        if (!walFollower.needReload && stat(path_in_data(WAL_FILE_NAME).c_str(), &st) == 0 &&
+            (walFollower.fd < 0 || st.st_dev != walFollower.dev || st.st_ino != walFollower.ino)) {
+            if (walFollower.fd >= 0) close(walFollower.fd);
+            walFollower.fd = open(path_in_data(WAL_FILE_NAME).c_str(), O_RDONLY | O_CLOEXEC);
+            walFollower.dev = st.st_dev;
+            walFollower.ino = st.st_ino;
+            walFollower.offset = 0;
+            walFollower.pending.clear();
+            wal_follow_read();
+        }
+        if (!walFollower.needReload) return;
+    }
+}
+
+// Called by app_startup before recovery. Returns true if this process is the primary;
+// otherwise it has loaded the primary's state and become a secondary window.
+static bool instance_start() {
+    if (instance_try_lock()) return true;
+    instanceSecondary = true;
+    wal_follow_poll();
+    instance_connect_primary();
+    fprintf(stderr, "instance: %s is in use by pid %d; %s\n", user_data_dir().c_str(), instancePrimaryPid,
+            instancePrimary.fd >= 0 ? "sending changes to it" : "opening read-only");
+    instanceNextFollow = instanceNextRetry = std::chrono::steady_clock::now() + kInstanceFollowInterval;
+    return false;
+}
+
+// The primary released the lock: finish reading its journal and continue in its place.
+static void instance_promote() {
+    wal_follow_poll();
+    // A primary that crashed mid-write leaves a torn frame in `pending`. Cut it off as
+    // wal_recover() does; records appended after it would be lost at the next recovery.
+    struct stat st;
+    std::string walPath = path_in_data(WAL_FILE_NAME);
+    if (walFollower.fd >= 0 && !walFollower.pending.empty() && stat(walPath.c_str(), &st) == 0 &&
+        st.st_dev == walFollower.dev && st.st_ino == walFollower.ino) {
+        uint64_t good = walFollower.offset - walFollower.pending.size();
+        fprintf(stderr, "journal.wal: discarding %zu trailing bytes after seq %llu\n",
+                walFollower.pending.size(), (unsigned long long)(wal_next_seq - 1));
+        if (truncate(walPath.c_str(), (off_t)good) != 0) perror("journal.wal: truncate");
+    }
+    if (walFollower.fd >= 0) close(walFollower.fd);
+    walFollower = JournalFollower();
+    if (instancePrimary.fd >= 0) close(instancePrimary.fd);
+    instancePrimary = IpcClient();
+    instanceSecondary = false;
+    wal_resume_session();
+    app_start_primary_services();
+    fprintf(stderr, "instance: pid %d exited; this instance is now the primary\n", instancePrimaryPid);
+}
+
+// Called once per frame on the UI thread.
+static void instance_poll() {
+    if (!instanceSecondary) return;
+    auto now = std::chrono::steady_clock::now();
+    bool replies = false;
+    if (instancePrimary.fd >= 0) {
+        ipc_flush(instancePrimary);
+        char buf[4096];
+        for (;;) {
+            ssize_t n = recv(instancePrimary.fd, buf, sizeof(buf), 0);
+            if (n > 0) { instancePrimary.in.append(buf, (size_t)n); continue; }
+            if (n == 0) { instancePrimary.eof = true; break; }
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) instancePrimary.eof = true;
+            break;
+        }
+        size_t start = 0, nl;
+        while ((nl = instancePrimary.in.find('\n', start)) != std::string::npos) {
+            if (instancePrimary.in.compare(start, 3, "ERR") == 0)
+                fprintf(stderr, "primary: %s\n", instancePrimary.in.substr(start, nl - start).c_str());
+            start = nl + 1;
+            replies = true;
+        }
+        instancePrimary.in.erase(0, start);
+        if (instancePrimary.eof) {
+            close(instancePrimary.fd);
+            instancePrimary = IpcClient();
+        }
+    }
+    // An "OK" means the primary's journal already holds the change
+    if (replies || now >= instanceNextFollow) {
+        wal_follow_poll();
+        instanceNextFollow = now + kInstanceFollowInterval;
+    }
+    if (now >= instanceNextRetry) {
+        instanceNextRetry = now + kInstanceRetryInterval;
+        if (instance_try_lock()) instance_promote();
+        else if (instancePrimary.fd < 0) instance_connect_primary();
+    }
+}
+
+// One line for the top of a secondary window.
+static const char* instance_banner() {
+    static char buf[160];
+    if (instancePrimary.fd >= 0)
+        snprintf(buf, sizeof(buf), "Another instance (pid %d) owns this data; changes made here are sent to it.", instancePrimaryPid);
+    else
+        snprintf(buf, sizeof(buf), "Read-only: another instance (pid %d) owns this data and cannot be reached.", instancePrimaryPid);
+    return buf;
+}
+
+// Shutdown: hand queued commands to the primary, then drop the lock (a primary does
+// this only after its final snapshot, so a waiting secondary starts from it).
+static void instance_release() {
+    if (instancePrimary.fd >= 0) {
+        fcntl(instancePrimary.fd, F_SETFL, fcntl(instancePrimary.fd, F_GETFL, 0) & ~O_NONBLOCK);
+        ipc_flush(instancePrimary);
+        close(instancePrimary.fd);
+        instancePrimary = IpcClient();
+    }
+    if (walFollower.fd >= 0) close(walFollower.fd);
+    walFollower = JournalFollower();
+    if (instanceLockFd >= 0) close(instanceLockFd);
+    instanceLockFd = -1;
+}
+#else
+static bool instance_is_secondary() { return false; }
+static bool instance_forward(const std::string &) { return false; }
+static bool instance_start() { return true; }
+static void instance_poll() {}
+static const char* instance_banner() { return ""; }
+static void instance_release() {}
+#endif
+
+// ----------------------- Live reload --------------------------------------
+// Picks up changes other processes make to daily_logs.txt and tasks.txt while the app
+// runs (Linux, inotify; flat-file storage only). A watcher thread does all file I/O
+// and parsing and posts the results to the UI thread:
+//  - daily_logs.txt is tailed from the byte offset seen last, never reloaded. The app
+//    appends with O_APPEND and records the byte range of each of its writes; lines in
+//    those ranges are skipped, others are journaled as Log records (not re-appended to
+//    the file).
+//    A hash of the last 4 KiB before the offset detects rewrites and replacements: once
+//    the writer closes the file, tailing continues if that tail is unchanged (the file
+//    was only extended) and otherwise restarts at the file's new end.
+//  - tasks.txt is re-read when it is closed after writing or replaced. Content equal
+//    to one of the app's own recent writes is ignored; otherwise tasks are merged:
+//    matched by name and parent, new ones added, done flags taken from the file.
+//    Tasks missing from the file are kept. The merged list is saved back.
+#ifdef __linux__
+struct LiveReload {
+    std::thread thread;
+    int inotifyFd = -1;
+    int wakeFd = -1;
+    std::atomic<bool> running{false};
+    std::mutex mu;                        // guards ownRanges / ownTasks; held across own appends
+    std::deque<std::pair<uint64_t, uint64_t>> ownRanges; // [begin, end) of the app's appends, not yet tailed
+    std::deque<uint64_t> ownTasks;        // hashes of the app's recent tasks.txt contents
+    // watcher thread only
+    std::string dir;
+    uint64_t tailOffset = 0;
+    uint64_t tailHash = 0;                // fnv1a of up to kLiveReloadTailWindow bytes before tailOffset
+    std::string partial;                  // incomplete last line
+    uint64_t partialOffset = 0;           // file offset of partial[0]
+};
+static LiveReload liveReload;
+static const size_t kLiveReloadTailWindow = 4096;
+
+// Appends `bytes` to daily_logs.txt and returns the file range they landed in. mu is
+// held from the write until its range is recorded, so the tailer, which checks ranges
+// under mu after reading, never sees the bytes without their range.
+static bool live_reload_append_own(const std::string &path, const std::string &bytes, uint64_t &begin, uint64_t &end) {
+    bool tracked = liveReload.running.load(std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(liveReload.mu, std::defer_lock);
+    if (tracked) lock.lock();
+    int fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) { perror("append daily_logs.txt"); return false; }
+    size_t done = 0;
+    while (done < bytes.size()) {
+        ssize_t n = write(fd, bytes.data() + done, bytes.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) { perror("append daily_logs.txt"); break; }
+        off_t pos = lseek(fd, 0, SEEK_CUR);
+        if (pos < 0) { done += (size_t)n; continue; }
+        uint64_t b = (uint64_t)pos - (uint64_t)n, e = (uint64_t)pos;
+        if (done == 0) begin = b;
+        end = e;
+        done += (size_t)n;
+        if (!tracked) continue;
+        auto &q = liveReload.ownRanges;
+        if (!q.empty() && q.back().second == b) q.back().second = e;
+        else q.emplace_back(b, e);
+    }
+    close(fd);
+    return done == bytes.size();
+}
+static bool live_reload_running() { return liveReload.running.load(std::memory_order_relaxed); }
+static void live_reload_note_own_tasks(const std::string &content) {
+    if (!liveReload.running.load(std::memory_order_relaxed)) return;
+    std::lock_guard<std::mutex> lock(liveReload.mu);
+    liveReload.ownTasks.push_back(fnv1a(content));
+    if (liveReload.ownTasks.size() > 8) liveReload.ownTasks.pop_front();
+}
+// True if the bytes [begin, end) were appended by the app. Lines are checked in file
+// order, so ranges that end before `begin` are done with.
+static bool live_reload_is_own(uint64_t begin, uint64_t end) {
+    std::lock_guard<std::mutex> lock(liveReload.mu);
+    auto &q = liveReload.ownRanges;
+    while (!q.empty() && q.front().second <= begin) q.pop_front();
+    return !q.empty() && q.front().first <= begin && end <= q.front().second;
+}
+
+// UI thread: journal externally appended log lines.
+static void live_reload_apply_logs(const std::vector<DailyLog> &logs, uint64_t fileEnd) {
+    wal_begin_batch();
+    for (const auto &d : logs) {
+        WalRecord r; r.op = WalOp::Log; r.ts = (int64_t)d.ts; r.s1 = d.type; r.s2 = d.text;
+        wal_commit(r);
+    }
+    storage_backend().import_logs(logs, fileEnd);
+    wal_end_batch();
+}
+// UI thread: merge an externally written task list.
+static void live_reload_apply_tasks(const std::vector<Task> &ext) {
+    std::map<std::pair<int, std::string>, int> byKey;
+    for (size_t i = 0; i < tasks.size(); ++i) byKey.emplace(std::make_pair(tasks[i].parent, tasks[i].name), (int)i);
+    std::vector<int> mapped(ext.size(), -1);
+    int added = 0, toggled = 0;
+    wal_begin_batch();
+    for (size_t i = 0; i < ext.size(); ++i) {
+        const Task &e = ext[i];
+        int parent = (e.parent >= 0 && e.parent < (int)i) ? mapped[e.parent] : -1;
+        auto it = byKey.find(std::make_pair(parent, e.name));
+        int idx;
+        if (it != byKey.end()) {
+            idx = it->second;
+        } else {
+            add_task(e.name, parent);
+            idx = (int)tasks.size() - 1;
+            byKey.emplace(std::make_pair(parent, e.name), idx);
+            ++added;
+        }
+        mapped[i] = idx;
+        if (tasks[idx].done != e.done) { set_task_done(idx, e.done); ++toggled; }
+    }
+    wal_end_batch();
+    if (added || toggled) fprintf(stderr, "live reload: tasks.txt merged (%d added, %d toggled)\n", added, toggled);
+}
+
+// Hash of the kLiveReloadTailWindow bytes of `fd` before `offset`.
+static uint64_t live_reload_tail_hash(int fd, uint64_t offset) {
+    char buf[kLiveReloadTailWindow];
+    size_t want = (size_t)std::min<uint64_t>(offset, sizeof(buf));
+    ssize_t n = want ? pread(fd, buf, want, (off_t)(offset - want)) : 0;
+    return fnv1a(std::string(buf, n > 0 ? (size_t)n : 0));
+}
+
+// Watcher thread: read bytes appended since the last call. `closed` is set when the
+// event says a writer closed or moved the file into place.
+static void live_reload_tail_logs(bool closed) {
+    std::string path = liveReload.dir + "/daily_logs.txt";
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return; }
+    uint64_t size = (uint64_t)st.st_size;
+    if (size < liveReload.tailOffset || live_reload_tail_hash(fd, liveReload.tailOffset) != liveReload.tailHash) {
+        // Rewritten or replaced: wait until the writer is done, then follow from the end
+        if (closed) {
+            fprintf(stderr, "live reload: daily_logs.txt was rewritten; following it from its new end\n");
+            liveReload.tailOffset = size;
+            liveReload.tailHash = live_reload_tail_hash(fd, size);
+            liveReload.partial.clear();
+            liveReload.partialOffset = size;
+            std::lock_guard<std::mutex> lock(liveReload.mu);
+            liveReload.ownRanges.clear();
+        }
+        close(fd);
+        return;
+    }
+    std::vector<DailyLog> external;
+    char buf[64 * 1024];
+    while (liveReload.tailOffset < size) {
+        ssize_t n = pread(fd, buf, sizeof(buf), (off_t)liveReload.tailOffset);
+        if (n <= 0) break;
+        liveReload.tailOffset += (uint64_t)n;
+        liveReload.partial.append(buf, (size_t)n);
+        size_t start = 0, nl;
+        while ((nl = liveReload.partial.find('\n', start)) != std::string::npos) {
+            std::string line = liveReload.partial.substr(start, nl - start);
+            uint64_t begin = liveReload.partialOffset + start;
+            start = nl + 1;
+            if (line.empty() || live_reload_is_own(begin, liveReload.partialOffset + start)) continue;
+            DailyLog d;
+            if (pt_parse_log_line(line, d.ts, d.type, d.text)) external.push_back(std::move(d));
+        }
+        liveReload.partial.erase(0, start);
+        liveReload.partialOffset += start;
+    }
+    liveReload.tailHash = live_reload_tail_hash(fd, liveReload.tailOffset);
+    close(fd);
+    uint64_t fileEnd = liveReload.partialOffset; // end of the last complete line
+    if (!external.empty()) post_to_ui([external = std::move(external), fileEnd] { live_reload_apply_logs(external, fileEnd); });
+}
+
+// Watcher thread: re-read tasks.txt after it changed.
+static void live_reload_read_tasks() {
+    std::ifstream f(liveReload.dir + "/tasks.txt", std::ios::binary);
+    if (!f) return;
+    std::string content((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    uint64_t h = fnv1a(content);
+    {
+        std::lock_guard<std::mutex> lock(liveReload.mu);
+        for (uint64_t own : liveReload.ownTasks) if (own == h) return;
+    }
+    std::vector<Task> ext;
+    std::istringstream in(content);
+    std::string line;
+    Task t;
+    while (std::getline(in, line)) {
+        if (pt_parse_task_line(line, t.name, t.parent, t.done)) ext.push_back(t);
+    }
+    post_to_ui([ext = std::move(ext)] { live_reload_apply_tasks(ext); });
+}
+
+static void live_reload_loop() {
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+        struct pollfd pfd[2] = { { liveReload.inotifyFd, POLLIN, 0 }, { liveReload.wakeFd, POLLIN, 0 } };
+        if (poll(pfd, 2, -1) < 0) { if (errno == EINTR) continue; break; }
+        if (pfd[1].revents) break;
+        ssize_t len = read(liveReload.inotifyFd, buf, sizeof(buf));
+        if (len <= 0) continue;
+        bool logs = false, logsClosed = false, taskFile = false;
+        for (char* p = buf; p < buf + len; ) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + ev->len;
+            if (!ev->len) continue;
+            bool closed = (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) != 0;
+            if (!strcmp(ev->name, "daily_logs.txt")) { logs = true; logsClosed |= closed; }
+            else if (!strcmp(ev->name, "tasks.txt") && closed) taskFile = true;
+        }
+        if (logs) live_reload_tail_logs(logsClosed);
+        if (taskFile) live_reload_read_tasks();
+    }
+}
+
+static void live_reload_start() {
+    liveReload.dir = user_data_dir();
+    liveReload.tailOffset = 0;
+    liveReload.tailHash = live_reload_tail_hash(-1, 0);
+    int fd = open((liveReload.dir + "/daily_logs.txt").c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0) {
+        liveReload.tailOffset = (uint64_t)st.st_size;
+        liveReload.tailHash = live_reload_tail_hash(fd, liveReload.tailOffset);
+    }
+    if (fd >= 0) close(fd);
+    liveReload.partial.clear();
+    liveReload.partialOffset = liveReload.tailOffset;
+    liveReload.inotifyFd = inotify_init1(IN_CLOEXEC);
+    if (liveReload.inotifyFd < 0) { perror("live reload: inotify_init1"); return; }
+    if (inotify_add_watch(liveReload.inotifyFd, liveReload.dir.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        perror("live reload: inotify_add_watch");
+        close(liveReload.inotifyFd);
+        liveReload.inotifyFd = -1;
+        return;
+    }
+    liveReload.wakeFd = eventfd(0, EFD_CLOEXEC);
+    {
+        std::ifstream f(liveReload.dir + "/tasks.txt", std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        liveReload.ownTasks.assign(1, fnv1a(content));
+    }
+    liveReload.running.store(true);
+    liveReload.thread = std::thread(live_reload_loop);
+}
+static void live_reload_stop() {
+    if (!liveReload.running.load()) return;
+    uint64_t one = 1;
+    if (write(liveReload.wakeFd, &one, sizeof(one)) < 0) perror("live reload: wake");
+    liveReload.thread.join();
+    liveReload.running.store(false);
+    close(liveReload.inotifyFd);
+    close(liveReload.wakeFd);
+    liveReload.inotifyFd = liveReload.wakeFd = -1;
+    liveReload.ownRanges.clear();
+    liveReload.ownTasks.clear();
+}
+#else
+static bool live_reload_append_own(const std::string &path, const std::string &bytes, uint64_t &begin, uint64_t &end) {
+    std::ofstream f(path, std::ios::app | std::ios::binary);
+    f << bytes;
+    end = (uint64_t)std::max<std::streamoff>(0, (std::streamoff)f.tellp());
+    begin = end >= bytes.size() ? end - bytes.size() : 0;
+    return (bool)f;
+}
+static void live_reload_note_own_tasks(const std::string &) {}
+static bool live_reload_running() { return false; }
+static void live_reload_start() {}
+static void live_reload_stop() {}
+#endif
+
+// ----------------------- Local HTTP/JSON API ------------------------------
+// Optional read-only API for dashboards, enabled by PT_HTTP_PORT=<port>. Listens on
+// 127.0.0.1 only. Endpoints (all GET, JSON):
+//   /api/logs/today   today's log entries
+//   /api/tasks        task tree
+//   /api/breaks       active breaks and today's break totals per type
+//   /api/timer        session timer
+// The server is one thread running an epoll loop (Linux) with keep-alive. It never
+// touches app state: the UI thread serializes the responses into an immutable
+// ApiSnapshot and publishes it with an atomic shared_ptr store; requests atomically
+// load the current one. A snapshot is rebuilt when the journal sequence or the day
+// changes, at most every kApiPublishInterval.
+struct ApiSnapshot {
+    std::string logsToday;
+    std::string tasks;
+    std::string breaks;
+    // timer fields; tracked time is computed at request time from these
+    long accumulated = 0;
+    time_t trackingStart = 0;
+    time_t sessionStart = 0;
+};
+static std::shared_ptr<const ApiSnapshot> apiSnapshot; // accessed only via std::atomic_load/store
+static const std::chrono::milliseconds kApiPublishInterval(250);
+static bool apiEnabled = false;
+static uint64_t apiPublishedSeq = 0;
+static int32_t apiPublishedDay = 0;
+static std::chrono::steady_clock::time_point apiLastPublish;
+
+static void api_task_json(std::string &out, int idx, const std::vector<std::vector<int>> &children, int depth) {
+    out += "{\"index\":" + std::to_string(idx) + ",\"name\":\"" + json_escape(tasks[idx].name) + "\",\"done\":" + (tasks[idx].done ? "true" : "false") + ",\"children\":[";
+    if (depth < 64) {
+        for (size_t k = 0; k < children[idx].size(); ++k) {
+            if (k) out += ',';
+            api_task_json(out, children[idx][k], children, depth + 1);
+        }
+    }
+    out += "]}";
+}
+
+static std::shared_ptr<const ApiSnapshot> build_api_snapshot() {
+    auto snap = std::make_shared<ApiSnapshot>();
+    int32_t today = local_day_index(time(nullptr));
+
+    std::string &logs = snap->logsToday;
+    logs = "[";
+    bool first = true;
+    for_each_log_in_days(today, today, [&](const DailyLog &d) {
+        if (!first) logs += ',';
+        first = false;
+        logs += "{\"ts\":" + std::to_string((long long)d.ts) + ",\"type\":\"" + json_escape(d.type) + "\",\"text\":\"" + json_escape(d.text) + "\"}";
+    });
+    logs += "]";
+
+    std::vector<std::vector<int>> children(tasks.size());
+    std::vector<int> roots;
+    for (int i = 0; i < (int)tasks.size(); ++i) {
+        int p = tasks[i].parent;
+        if (p >= 0 && p < (int)tasks.size() && p != i) children[p].push_back(i);
+        else roots.push_back(i);
+    }
+    snap->tasks = "[";
+    for (size_t k = 0; k < roots.size(); ++k) {
+        if (k) snap->tasks += ',';
+        api_task_json(snap->tasks, roots[k], children, 0);
+    }
+    snap->tasks += "]";
+
+    std::string &br = snap->breaks;
+    br = "{\"active\":[";
+    first = true;
+    for (const auto &b : breaks) {
+        if (b.end != 0) continue;
+        if (!first) br += ',';
+        first = false;
+        br += "{\"type\":\"" + json_escape(b.type) + "\",\"start\":" + std::to_string((long long)b.start) + "}";
+    }
+    AggregateTotals tot = agg_totals(today, today);
+    br += "],\"today_seconds\":" + std::to_string(tot.total_break_seconds()) + ",\"today_by_type\":{";
+    for (int s = 0; s < kBreakTypeSlots; ++s) {
+        if (s) br += ',';
+        br += "\"" + json_escape(s < (int)kBreakTypes.size() && s < kBreakTypeSlots - 1 ? kBreakTypes[s] : std::string("Other")) + "\":" + std::to_string(tot.break_seconds[s]);
+    }
+    br += "}}";
+
+    snap->accumulated = accumulated_tracked_seconds;
+    snap->trackingStart = tracking_start_time;
+    snap->sessionStart = app_start_time;
+    return snap;
+}
+
+// UI thread, once per frame.
+static void api_publish_if_changed() {
+    if (!apiEnabled) return;
+    auto now = std::chrono::steady_clock::now();
+    int32_t today = local_day_index(time(nullptr));
+    if (apiPublishedSeq == wal_next_seq && apiPublishedDay == today) return;
+    if (now - apiLastPublish < kApiPublishInterval) return;
+    std::atomic_store(&apiSnapshot, build_api_snapshot());
+    apiPublishedSeq = wal_next_seq;
+    apiPublishedDay = today;
+    apiLastPublish = now;
+}
+
+#ifdef __linux__
+struct HttpConn {
+    std::string in;
+    std::string out;
+    bool closeAfterWrite = false;
+    std::chrono::steady_clock::time_point lastActive;
+};
+static std::thread apiThread;
+static int apiWakeFd = -1; // eventfd used to stop the loop
+static const size_t kHttpMaxRequest = 16 * 1024;
+static const int kHttpIdleSeconds = 30;
+static const size_t kHttpMaxConns = 256;
+static int apiPort = 0;
+
+// DNS rebinding guard: a page served from another origin can reach 127.0.0.1 under
+// its own host name, so exactly one Host header naming the loopback port is required.
+// `lowerHead` is the lowercased request head (request line + header lines).
+static bool http_host_allowed(const std::string &lowerHead) {
+    std::string host;
+    int seen = 0;
+    size_t pos = lowerHead.find("\r\n");
+    while (pos != std::string::npos) {
+        size_t start = pos + 2;
+        pos = lowerHead.find("\r\n", start);
+        std::string line = lowerHead.substr(start, pos == std::string::npos ? std::string::npos : pos - start);
+        if (line.compare(0, 5, "host:") != 0) continue;
+        size_t b = line.find_first_not_of(" \t", 5), e = line.find_last_not_of(" \t");
+        host = (b == std::string::npos) ? std::string() : line.substr(b, e - b + 1);
+        ++seen;
+    }
+    if (seen != 1) return false;
+    std::string port = ":" + std::to_string(apiPort);
+    return host == "127.0.0.1" + port || host == "localhost" + port;
+}
+
+static void http_respond(HttpConn &c, int status, const char* reason, const std::string &body, bool keepAlive) {
+    c.out += "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\n"
+             "Content-Type: application/json\r\n"
+             "Cache-Control: no-store\r\n"
+             "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+             (keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+    c.out += body;
+    if (!keepAlive) c.closeAfterWrite = true;
+}
+
+// Parses and answers every complete request in c.in (pipelining is allowed).
+static void http_handle_requests(HttpConn &c) {
+    for (;;) {
+        size_t end = c.in.find("\r\n\r\n");
+        if (end == std::string::npos) {
+            if (c.in.size() > kHttpMaxRequest) http_respond(c, 431, "Request Header Fields Too Large", "{\"error\":\"request too large\"}", false);
+            return;
+        }
+        std::string head = c.in.substr(0, end);
+        c.in.erase(0, end + 4);
+
+        std::istringstream hs(head);
+        std::string method, target, version;
+        hs >> method >> target >> version;
+        std::string lower = to_lower_ascii(head);
+        bool keepAlive = (version == "HTTP/1.1") ? lower.find("connection: close") == std::string::npos
+                                                 : lower.find("connection: keep-alive") != std::string::npos;
+        if (lower.find("content-length:") != std::string::npos || lower.find("transfer-encoding:") != std::string::npos) {
+            http_respond(c, 400, "Bad Request", "{\"error\":\"request bodies are not supported\"}", false);
+            return;
+        }
+        if (!http_host_allowed(lower)) { http_respond(c, 403, "Forbidden", "{\"error\":\"bad host\"}", false); return; }
+        if (method != "GET") { http_respond(c, 405, "Method Not Allowed", "{\"error\":\"GET only\"}", keepAlive); continue; }
+        size_t q = target.find('?');
+        if (q != std::string::npos) target.resize(q);
+
+        std::shared_ptr<const ApiSnapshot> snap = std::atomic_load(&apiSnapshot);
+        if (!snap) { http_respond(c, 503, "Service Unavailable", "{\"error\":\"starting\"}", keepAlive); continue; }
+        if (target == "/api/logs/today") http_respond(c, 200, "OK", snap->logsToday, keepAlive);
+        else if (target == "/api/tasks") http_respond(c, 200, "OK", snap->tasks, keepAlive);
+        else if (target == "/api/breaks") http_respond(c, 200, "OK", snap->breaks, keepAlive);
+        else if (target == "/api/timer") {
+            time_t now = time(nullptr);
+            long tracked = snap->accumulated + (snap->trackingStart ? (long)(now - snap->trackingStart) : 0L);
+            std::string body = "{\"tracked_seconds\":" + std::to_string(tracked) +
+                               ",\"running\":" + (snap->trackingStart ? "true" : "false") +
+                               ",\"session_start\":" + std::to_string((long long)snap->sessionStart) +
+                               ",\"now\":" + std::to_string((long long)now) + "}";
+            http_respond(c, 200, "OK", body, keepAlive);
+        }
+        else http_respond(c, 404, "Not Found", "{\"error\":\"not found\"}", keepAlive);
+        if (c.closeAfterWrite) return;
+    }
+}
+
+static void http_loop(int listenFd, int wakeFd) {
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    if (ep < 0) { perror("http: epoll_create1"); close(listenFd); return; }
+    struct epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    epoll_ctl(ep, EPOLL_CTL_ADD, listenFd, &ev);
+    ev.data.fd = wakeFd;
+    epoll_ctl(ep, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    std::unordered_map<int, HttpConn> conns;
+    auto close_conn = [&](int fd) { epoll_ctl(ep, EPOLL_CTL_DEL, fd, nullptr); close(fd); conns.erase(fd); };
+    auto want = [&](int fd, const HttpConn &c) {
+        struct epoll_event e{};
+        e.events = EPOLLIN | (c.out.empty() ? 0u : (uint32_t)EPOLLOUT);
+        e.data.fd = fd;
+        epoll_ctl(ep, EPOLL_CTL_MOD, fd, &e);
+    };
+    struct epoll_event events[64];
+    char buf[16384];
+    bool running = true;
+    while (running) {
+        int n = epoll_wait(ep, events, 64, 1000);
+        auto now = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd) { running = false; break; }
+            if (fd == listenFd) {
+                for (;;) {
+                    int cfd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (cfd < 0) break;
+                    if (conns.size() >= kHttpMaxConns) { close(cfd); continue; }
+                    struct epoll_event e{};
+                    e.events = EPOLLIN;
+                    e.data.fd = cfd;
+                    epoll_ctl(ep, EPOLL_CTL_ADD, cfd, &e);
+                    conns[cfd].lastActive = now;
+                }
+                continue;
+            }
+            auto it = conns.find(fd);
+            if (it == conns.end()) continue;
+            HttpConn &c = it->second;
+            c.lastActive = now;
+            bool dead = (events[i].events & (EPOLLERR | EPOLLHUP)) != 0;
+            if (!dead && (events[i].events & EPOLLIN)) {
+                for (;;) {
+                    ssize_t r = recv(fd, buf, sizeof(buf), 0);
+                    if (r > 0) { c.in.append(buf, (size_t)r); if (c.in.size() > kHttpMaxRequest * 4) break; continue; }
+                    if (r == 0) dead = c.out.empty();
+                    else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) dead = true;
+                    break;
+                }
+                if (!dead && !c.closeAfterWrite) http_handle_requests(c);
+            }
+            while (!dead && !c.out.empty()) {
+                ssize_t w = send(fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+                if (w > 0) { c.out.erase(0, (size_t)w); continue; }
+                if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                if (w < 0 && errno == EINTR) continue;
+                dead = true;
+            }
+            if (dead || (c.out.empty() && c.closeAfterWrite)) close_conn(fd);
+            else want(fd, c);
+        }
+        // Drop idle keep-alive connections
+        for (auto it = conns.begin(); it != conns.end();) {
+            if (now - it->second.lastActive > std::chrono::seconds(kHttpIdleSeconds)) {
+                int fd = it->first;
+                ++it;
+                close_conn(fd);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto &kv : conns) close(kv.first);
+    close(ep);
+    close(listenFd);
+}
+
+static void api_start() {
+    const char* portEnv = getenv("PT_HTTP_PORT");
+    if (!portEnv || !*portEnv) return;
+    int port = atoi(portEnv);
+    if (port <= 0 || port > 65535) { fprintf(stderr, "http: invalid PT_HTTP_PORT '%s'\n", portEnv); return; }
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) { perror("http: socket"); return; }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 64) != 0) {
+        perror("http: bind/listen");
+        close(fd);
+        return;
+    }
+    apiWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (apiWakeFd < 0) { perror("http: eventfd"); close(fd); return; }
+    apiPort = port;
+    apiEnabled = true;
+    api_publish_if_changed(); // first snapshot before any request can arrive
+    apiThread = std::thread(http_loop, fd, apiWakeFd);
+}
+
+static void api_stop() {
+    if (!apiThread.joinable()) return;
+    uint64_t one = 1;
+    if (write(apiWakeFd, &one, sizeof(one)) < 0) perror("http: eventfd write");
+    apiThread.join();
+    close(apiWakeFd);
+    apiWakeFd = -1;
+    apiEnabled = false;
+}
+#else
+static void api_start() {
+    const char* portEnv = getenv("PT_HTTP_PORT");
+    if (portEnv && *portEnv) fprintf(stderr, "http: the local API is only available on Linux\n");
+}
+static void api_stop() {}
+#endif
+
+// ----------------------- Shared-memory status page ------------------------
+// Session state for status bars, published to POSIX shared memory (status_page.h,
+// read by the pt_status CLI). Updated from wal_apply, i.e. on every state change;
+// readers compute the live tracked time themselves.
+#ifndef _WIN32
+static PtStatusPage* statusPage = nullptr;
+static char statusPageName[64];
+
+static void status_page_open() {
+    pt_status_shm_name(user_data_dir(), statusPageName, sizeof(statusPageName));
+    int fd = shm_open(statusPageName, O_CREAT | O_RDWR, 0600);
+    if (fd < 0) { perror("status page: shm_open"); return; }
+    if (ftruncate(fd, sizeof(PtStatusPage)) != 0) { perror("status page: ftruncate"); close(fd); return; }
+    void* p = mmap(nullptr, sizeof(PtStatusPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) { perror("status page: mmap"); return; }
+    statusPage = (PtStatusPage*)p;
+    statusPage->magic = PT_STATUS_MAGIC;
+    statusPage->version = PT_STATUS_VERSION;
+    status_page_publish();
+}
+
+static void status_page_publish() {
+    if (!statusPage) return;
+    PtStatus st{};
+    st.pid = (uint32_t)getpid();
+    st.tracking = tracking_start_time != 0 ? 1 : 0;
+    st.active_breaks = (uint32_t)active_breaks_count();
+    st.accumulated_tracked_seconds = accumulated_tracked_seconds;
+    st.tracking_start_time = (int64_t)tracking_start_time;
+    st.session_start_time = (int64_t)app_start_time;
+    // most recently started active break
+    for (const auto &kv : active_breaks_by_type) {
+        for (int idx : kv.second) {
+            if ((int64_t)breaks[idx].start >= st.active_break_start) {
+                st.active_break_start = (int64_t)breaks[idx].start;
+                snprintf(st.active_break_type, sizeof(st.active_break_type), "%s", breaks[idx].type.c_str());
+            }
+        }
+    }
+    auto hourly = logTypeFacetIds.find("HOURLY");
+    if (hourly != logTypeFacetIds.end() && !logTypeFacets[hourly->second].logs.empty())
+        st.last_hourly_log_time = (int64_t)dailyLogs[logTypeFacets[hourly->second].logs.back()].ts;
+    st.updated_at = (int64_t)time(nullptr);
+    pt_status_write(statusPage, st);
+    statusPage->heartbeat.store(st.updated_at, std::memory_order_relaxed);
+}
+
+// Once a frame; stores only when the second changes.
+static void status_page_heartbeat() {
+    if (!statusPage) return;
+    int64_t now = (int64_t)time(nullptr);
+    if (statusPage->heartbeat.load(std::memory_order_relaxed) != now) statusPage->heartbeat.store(now, std::memory_order_relaxed);
+}
+
+static void status_page_close() {
+    if (!statusPage) return;
+    PtStatus st{}; // pid 0: not running
+    st.updated_at = (int64_t)time(nullptr);
+    pt_status_write(statusPage, st);
+    munmap(statusPage, sizeof(PtStatusPage));
+    statusPage = nullptr;
+    shm_unlink(statusPageName);
+}
+#else
+static void status_page_open() {}
+static void status_page_publish() {}
+static void status_page_heartbeat() {}
+static void status_page_close() {}
+#endif
+
+// ----------------------- Productivity analysis ------------------------------
+// Native replacement for the collection step of analyze_productivity.py: the prompt
+// is built from the day index (last ANALYSIS_DAYS calendar days of logs + the task
+// list) and streamed into the analyzer backend's stdin in fixed-size chunks.
+//
+// The backend is any command that reads a prompt on stdin and writes the summary to
+// stdout. It defaults to `ollama run mistral`; put a different command on the first
+// line of ~/.productivity_tracker/analyzer_command.txt to plug in another one.
+//
+// On POSIX the backend runs as a managed child (posix_spawn, non-blocking pipes)
+// that is pumped once per frame from the main loop: at most one run at a time, with
+// streamed output shown in the Analysis window, cancellation and a timeout.
+static const int ANALYSIS_DAYS = 7;
+static const int ANALYSIS_TIMEOUT_SECONDS = 300;
+static const size_t ANALYSIS_OUTPUT_LIMIT = 4 * 1024 * 1024;
+static const char* DEFAULT_ANALYZER_COMMAND = "ollama run mistral";
+static const char* ANALYZER_COMMAND_FILE = "analyzer_command.txt";
+static const char* ANALYSIS_SUMMARY_FILE = "ai_weekly_summary.txt";
+
+// The files analyze_productivity.py collects (glob patterns relative to the data dir).
+static const char* const kAnalysisPatterns[] = {
+    "weekly_status_export_*", "tasks*", "hourly_logs_today_*", "dailt_statu_*", "daily_status_*", "daily_logs.txt",
+};
+
+// One "--- <name> ---" section of the prompt. daily_logs.txt and tasks.txt come from
+// memory (the logs of the last ANALYSIS_DAYS calendar days, the task list); other
+// sources are streamed from the file of that name in the data dir.
+struct AnalysisSource {
+    enum Kind { Logs, Tasks, File } kind = File;
+    std::string name;
+};
+
+// Everything the prompt needs. The in-memory parts are copied on the UI thread so
+// nothing else touches live state; the file sources are found by a pool job.
+struct AnalysisInput {
+    std::vector<DailyLog> logs;
+    std::vector<Task> tasks;
+    std::vector<AnalysisSource> sources; // in prompt order
+};
+
+static AnalysisInput snapshot_analysis_input() {
+    AnalysisInput in;
+    int32_t today = local_day_index(time(nullptr));
+    for_each_log_in_days(today - ANALYSIS_DAYS + 1, today, [&](const DailyLog &d) { in.logs.push_back(d); });
+    in.tasks = tasks;
+    return in;
+}
+
+// Runs on the job pool. The script's sources in its order (sorted by path): files
+// matching kAnalysisPatterns changed in the last ANALYSIS_DAYS * 24 hours, by the
+// export manifest's time where an export is listed there (exports that share content
+// share an mtime). Only names are collected; the contents are read while streaming.
+static void collect_analysis_files(AnalysisInput &in) {
+    std::unordered_map<std::string, int64_t> exportTimes;
+    for (const auto &e : export_manifest_read()) exportTimes[e.name] = e.time;
+    int64_t cutoff = (int64_t)time(nullptr) - (int64_t)ANALYSIS_DAYS * 86400;
+    std::string dir = user_data_dir();
+    std::set<std::string> names;
+    if (!in.logs.empty()) names.insert("daily_logs.txt");
+    if (!in.tasks.empty()) names.insert("tasks.txt");
+    for (const std::string &name : list_directory(dir)) {
+        bool match = false;
+        for (const char* pat : kAnalysisPatterns) {
+            size_t n = std::strlen(pat);
+            match = pat[n - 1] == '*' ? name.compare(0, n - 1, pat, n - 1) == 0 : name == pat;
+            if (match) break;
+        }
+        if (!match || name == "daily_logs.txt" || name == "tasks.txt") continue;
+        struct stat st;
+        if (stat((dir + "/" + name).c_str(), &st) != 0 || (st.st_mode & S_IFMT) != S_IFREG) continue;
+        auto t = exportTimes.find(name);
+        if ((t != exportTimes.end() ? t->second : (int64_t)st.st_mtime) >= cutoff) names.insert(name);
+    }
+    for (const std::string &name : names) {
+        AnalysisSource src;
+        src.name = name;
+        if (name == "daily_logs.txt") src.kind = AnalysisSource::Logs;
+        else if (name == "tasks.txt") src.kind = AnalysisSource::Tasks;
+        in.sources.push_back(std::move(src));
+    }
+}
+
+// Produces the text of analyze_productivity.py's build_prompt(load_logs(files)): the
+// fixed instructions, "LOGS:", then one "--- <file> ---" section per source joined by
+// blank lines. The one difference: the script sends all of daily_logs.txt, this only
+// the last ANALYSIS_DAYS days of it. Resumable, so the prompt is never held in memory
+// as a whole; file sections are read from disk a chunk at a time, and a file that can
+// no longer be opened is left out.
+class PromptGenerator {
+public:
+    explicit PromptGenerator(const AnalysisInput &in) : in_(in) {}
+    ~PromptGenerator() { if (file_) fclose(file_); }
+    PromptGenerator(const PromptGenerator &) = delete;
+    PromptGenerator &operator=(const PromptGenerator &) = delete;
+    bool done() const { return stage_ == Done; }
+    // Appends roughly `budget` bytes of prompt text to `out`.
+    void next(std::string &out, size_t budget = 64 * 1024) {
+        while (out.size() < budget && stage_ != Done) {
+            switch (stage_) {
+            case Header:
+                out += "Here are my productivity logs for this week. Please analyze and suggest ways I can "
+                       "improve my workflow, manage energy, and reduce distractions. "
+                       "Summarize patterns, recommend changes, and highlight both strengths and weaknesses.\n\n"
+                       "LOGS:\n";
+                stage_ = Title;
+                break;
+            case Title:
+                if (src_ >= in_.sources.size()) { stage_ = Done; break; }
+                if (in_.sources[src_].kind == AnalysisSource::File) {
+                    file_ = fopen((user_data_dir() + "/" + in_.sources[src_].name).c_str(), "rb");
+                    if (!file_) { ++src_; break; }
+                }
+                if (titles_++ > 0) out += "\n\n";
+                out += "--- " + in_.sources[src_].name + " ---\n";
+                pos_ = 0;
+                stage_ = Body;
+                break;
+            case Body: {
+                const AnalysisSource &src = in_.sources[src_];
+                bool more = false;
+                if (src.kind == AnalysisSource::Logs && pos_ < in_.logs.size()) {
+                    const DailyLog &d = in_.logs[pos_++];
+                    out += human_log_line(d.type.c_str(), d.text, d.ts);
+                    out += '\n';
+                    more = true;
+                } else if (src.kind == AnalysisSource::Tasks && pos_ < in_.tasks.size()) {
+                    const Task &t = in_.tasks[pos_];
+                    std::ostringstream line;
+                    line << pos_ << ": [" << (t.done ? "x" : " ") << "] " << t.name;
+                    if (t.parent != -1) line << " (parent=" << t.parent << ")";
+                    line << "\n";
+                    out += line.str();
+                    ++pos_;
+                    more = true;
+                } else if (src.kind == AnalysisSource::File && file_) {
+                    size_t old = out.size();
+                    out.resize(budget);
+                    size_t n = fread(&out[old], 1, budget - old, file_);
+                    out.resize(old + n);
+                    if (n > 0) more = true;
+                    else { fclose(file_); file_ = nullptr; }
+                }
+                if (!more) { ++src_; stage_ = Title; }
+                break;
+            }
+            case Done:
+                break;
+            }
+        }
+    }
+private:
+    enum Stage { Header, Title, Body, Done } stage_ = Header;
+    size_t src_ = 0;
+    size_t titles_ = 0;
+    size_t pos_ = 0;
+    FILE* file_ = nullptr;
+    const AnalysisInput &in_;
+};
+
+static std::string analyzer_command() {
+    std::ifstream f(path_in_data(ANALYZER_COMMAND_FILE));
+    std::string line;
+    if (f && std::getline(f, line)) {
+        while (!line.empty() && isspace((unsigned char)line.back())) line.pop_back();
+        if (!line.empty()) return line;
+    }
+    return std::string(DEFAULT_ANALYZER_COMMAND);
+}
+
+// The script's "paste into ChatGPT" fallback: keep the prompt for manual use.
+static std::string save_prompt_for_manual_use(const AnalysisInput &in, const std::string &why) {
+    time_t now = time(nullptr);
+    struct tm tm{};
+#if defined(_WIN32)
+    localtime_s(&tm, &now);
+#else
+    localtime_r(&now, &tm);
+#endif
+    char name[64];
+    std::strftime(name, sizeof(name), "ai_prompt_%Y%m%d_%H%M%S.txt", &tm);
+    std::string promptPath = path_in_data(name);
+    FILE* f = fopen(promptPath.c_str(), "wb");
+    if (!f) return why + "; the prompt could not be saved";
+    PromptGenerator gen(in);
+    std::string chunk;
+    while (!gen.done()) {
+        chunk.clear();
+        gen.next(chunk);
+        fwrite(chunk.data(), 1, chunk.size(), f);
+    }
+    fclose(f);
+    return why + "; prompt saved to " + promptPath;
+}
+
+enum class AnalysisState { Idle, Running, Succeeded, Failed, Cancelled, TimedOut };
+
+struct AnalysisRun {
+    AnalysisState state = AnalysisState::Idle;
+    std::string command;
+    AnalysisInput input;
+    std::unique_ptr<PromptGenerator> prompt;
+    std::string pending;  // prompt bytes generated but not yet accepted by the pipe
+    std::string output;   // backend stdout so far (the summary)
+    std::string errors;   // backend stderr so far (shown, never saved)
+    time_t started = 0;
+    time_t finished = 0;
+    int exit_code = -1;
+#ifndef _WIN32
+    pid_t pid = -1;
+    int stdin_fd = -1;
+    int stdout_fd = -1;
+    int stderr_fd = -1;
+    double kill_deadline = 0.0; // SIGKILL the group if still alive after SIGTERM
+#endif
+};
+static AnalysisRun analysis;
+static uint64_t analysisRunId = 0; // bumped per launch so a stale source listing is dropped
+static bool showAnalysisWindow = false;
+
+// True until the child has been reaped, so a cancelled run still blocks a new one.
+static bool analysis_running() {
+#ifndef _WIN32
+    if (analysis.pid > 0) return true;
+#endif
+    return analysis.state == AnalysisState::Running;
+}
+
+static void finish_analysis(AnalysisState st) {
+    analysis.state = st;
+    analysis.finished = time(nullptr);
+    std::string msg;
+    if (st == AnalysisState::Succeeded) {
+        std::string path = path_in_data(ANALYSIS_SUMMARY_FILE);
+        if (write_file_atomic(path, analysis.output + "\n")) msg = std::string("Analysis written to ") + path;
+        else msg = std::string("Analysis finished but ") + path + " could not be written";
+    } else if (st == AnalysisState::Cancelled) {
+        msg = "Analysis cancelled";
+    } else {
+        std::string why = std::string("Analyzer '") + analysis.command + "' "
+                        + (st == AnalysisState::TimedOut ? "timed out" : "failed (exit " + std::to_string(analysis.exit_code) + ")");
+        // regenerating the prompt reads the source files again: keep that off the UI thread
+        jobPool.submit([in = std::move(analysis.input), why]() {
+            std::string saved = save_prompt_for_manual_use(in, why);
+            post_to_ui([saved]() { append_daily_log("ANALYSIS", saved); });
+        }, JobPriority::Low);
+    }
+    analysis.prompt.reset();
+    analysis.pending.clear();
+    analysis.input = AnalysisInput();
+    if (!msg.empty()) append_daily_log("ANALYSIS", msg);
+}
+
+#ifndef _WIN32
+static void close_fd(int &fd) { if (fd >= 0) { close(fd); fd = -1; } }
+
+// Both ends close-on-exec; posix_spawn's dup2 gives the child its ends without the flag.
+static bool pipe_cloexec(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC) == 0;
+#else
+    if (pipe(fds) != 0) return false;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+#endif
+}
+
+static bool spawn_analyzer(const std::string &cmd) {
+    int in_pipe[2], out_pipe[2], err_pipe[2];
+    if (!pipe_cloexec(in_pipe)) return false;
+    if (!pipe_cloexec(out_pipe)) { close(in_pipe[0]); close(in_pipe[1]); return false; }
+    if (!pipe_cloexec(err_pipe)) {
+        for (int fd : { in_pipe[0], in_pipe[1], out_pipe[0], out_pipe[1] }) close(fd);
+        return false;
+    }
+
+    // stdout is the summary; stderr (progress, spinners) is only shown
+    posix_spawn_file_actions_t fa;
+    posix_spawn_file_actions_init(&fa);
+    posix_spawn_file_actions_adddup2(&fa, in_pipe[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&fa, out_pipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&fa, err_pipe[1], STDERR_FILENO);
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP); // own group so cancel reaches the whole pipeline
+    posix_spawnattr_setpgroup(&attr, 0);
+
+    const char* argv[] = { "/bin/sh", "-c", cmd.c_str(), nullptr };
+    pid_t pid = -1;
+    int rc = posix_spawn(&pid, "/bin/sh", &fa, &attr, const_cast<char* const*>(argv), environ);
+    posix_spawn_file_actions_destroy(&fa);
+    posix_spawnattr_destroy(&attr);
+    close(in_pipe[0]);
+    close(out_pipe[1]);
+    close(err_pipe[1]);
+    if (rc != 0) { close(in_pipe[1]); close(out_pipe[0]); close(err_pipe[0]); return false; }
+
+    for (int fd : { in_pipe[1], out_pipe[0], err_pipe[0] }) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    analysis.pid = pid;
+    analysis.stdin_fd = in_pipe[1];
+    analysis.stdout_fd = out_pipe[0];
+    analysis.stderr_fd = err_pipe[0];
+    return true;
+}
+
+static void cancel_analysis() {
+    if (analysis.state != AnalysisState::Running) return;
+    if (analysis.pid <= 0) { finish_analysis(AnalysisState::Cancelled); return; } // still collecting sources
+    kill(-analysis.pid, SIGTERM);
+    analysis.kill_deadline = glfwGetTime() + 2.0;
+    close_fd(analysis.stdin_fd);
+    analysis.exit_code = -1;
+    analysis.state = AnalysisState::Cancelled; // reaped by poll_analysis()
+}
+
+// Called once per frame on the UI thread: feeds stdin, drains stdout, reaps the child.
+static void poll_analysis() {
+    if (analysis.pid <= 0) return;
+    bool cancelled = (analysis.state != AnalysisState::Running);
+
+    // Feed the prompt until the pipe would block
+    while (!cancelled && analysis.stdin_fd >= 0) {
+        if (analysis.pending.empty()) {
+            if (analysis.prompt->done()) { close_fd(analysis.stdin_fd); break; }
+            analysis.prompt->next(analysis.pending);
+        }
+        ssize_t n = write(analysis.stdin_fd, analysis.pending.data(), analysis.pending.size());
+        if (n > 0) { analysis.pending.erase(0, (size_t)n); continue; }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0 && errno == EINTR) continue;
+        close_fd(analysis.stdin_fd); // EPIPE: backend stopped reading
+        break;
+    }
+
+    // Drain whatever output is available
+    auto drain = [](int &fd, std::string &into) {
+        char buf[16 * 1024];
+        while (fd >= 0) {
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n > 0) {
+                if (into.size() < ANALYSIS_OUTPUT_LIMIT) into.append(buf, (size_t)n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0) close_fd(fd);
+            break;
+        }
+    };
+    drain(analysis.stdout_fd, analysis.output);
+    drain(analysis.stderr_fd, analysis.errors);
+
+    if (analysis.state == AnalysisState::Running && time(nullptr) - analysis.started > ANALYSIS_TIMEOUT_SECONDS) {
+        kill(-analysis.pid, SIGTERM);
+        analysis.kill_deadline = glfwGetTime() + 2.0;
+        close_fd(analysis.stdin_fd);
+        analysis.state = AnalysisState::TimedOut;
+    }
+    if (analysis.kill_deadline > 0.0 && glfwGetTime() > analysis.kill_deadline) {
+        kill(-analysis.pid, SIGKILL);
+        analysis.kill_deadline = 0.0;
+    }
+
+    int status = 0;
+    pid_t r = waitpid(analysis.pid, &status, WNOHANG);
+    if (r != analysis.pid) return;
+    analysis.pid = -1;
+    drain(analysis.stdout_fd, analysis.output); // output written just before exiting
+    drain(analysis.stderr_fd, analysis.errors);
+    close_fd(analysis.stdin_fd);
+    close_fd(analysis.stdout_fd);
+    close_fd(analysis.stderr_fd);
+    analysis.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    if (analysis.state == AnalysisState::Running)
+        finish_analysis(analysis.exit_code == 0 ? AnalysisState::Succeeded : AnalysisState::Failed);
+    else
+        finish_analysis(analysis.state);
+}
+
+// Shutdown: make sure no analyzer outlives the app.
+static void stop_analysis_blocking() {
+    if (analysis.pid <= 0) return;
+    kill(-analysis.pid, SIGKILL);
+    waitpid(analysis.pid, nullptr, 0);
+    analysis.pid = -1;
+    close_fd(analysis.stdin_fd);
+    close_fd(analysis.stdout_fd);
+    close_fd(analysis.stderr_fd);
+}
+#else
+// Windows has no posix_spawn: the backend runs via _popen as a pool job with its
+// stdout redirected to a temp file, picked up by poll_analysis() once it finishes.
+static std::mutex analysis_result_mutex;
+static bool analysis_result_ready = false;
+static int analysis_result_code = -1;
+
+static std::string analysis_output_tmp_path() { return path_in_data(ANALYSIS_SUMMARY_FILE) + ".out"; }
+static std::string analysis_errors_tmp_path() { return path_in_data(ANALYSIS_SUMMARY_FILE) + ".err"; }
+static void cancel_analysis() {}
+static void poll_analysis() {
+    std::lock_guard<std::mutex> lock(analysis_result_mutex);
+    if (!analysis_result_ready) return;
+    analysis_result_ready = false;
+    analysis.exit_code = analysis_result_code;
+    read_whole_file(analysis_output_tmp_path(), analysis.output);
+    read_whole_file(analysis_errors_tmp_path(), analysis.errors);
+    std::remove(analysis_output_tmp_path().c_str());
+    std::remove(analysis_errors_tmp_path().c_str());
+    finish_analysis(analysis_result_code == 0 ? AnalysisState::Succeeded : AnalysisState::Failed);
+}
+static void stop_analysis_blocking() {}
+#endif
+
+// Second half of launch_analysis_script, back on the UI thread once the sources are
+// known. Dropped if the run was cancelled (or another one started) meanwhile.
+static void start_analyzer(uint64_t run, AnalysisInput in) {
+    if (run != analysisRunId || analysis.state != AnalysisState::Running) return;
+    if (in.sources.empty()) {
+        analysis.state = AnalysisState::Idle;
+        append_daily_log("ANALYSIS", std::string("No productivity logs found for the last week."));
+        return;
+    }
+    size_t entries = in.logs.size();
+
+    analysis.input = std::move(in);
+    analysis.prompt.reset(new PromptGenerator(analysis.input));
+    analysis.started = time(nullptr);
+    showAnalysisWindow = true;
+
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN); // a backend that exits early must not kill the app
+    if (!spawn_analyzer(analysis.command)) {
+        finish_analysis(AnalysisState::Failed);
+        return;
+    }
+#else
+    jobPool.submit([cmd = analysis.command + " > \"" + analysis_output_tmp_path() + "\" 2> \"" + analysis_errors_tmp_path() + "\"",
+                    &in = analysis.input]() {
+        int rc = -1;
+        FILE* p = _popen(cmd.c_str(), "w");
+        if (p) {
+            PromptGenerator gen(in);
+            std::string chunk;
+            while (!gen.done()) { chunk.clear(); gen.next(chunk); fwrite(chunk.data(), 1, chunk.size(), p); }
+            rc = _pclose(p);
+        }
+        std::lock_guard<std::mutex> lock(analysis_result_mutex);
+        analysis_result_code = rc;
+        analysis_result_ready = true;
+    }, JobPriority::Low);
+#endif
+
+    append_daily_log("ANALYSIS", std::string("Started analysis of ") + std::to_string(entries)
+                     + " log entries with: " + analysis.command);
+}
+
+// The run counts as started (analysis_running()) while a pool job lists the data dir
+// for its sources; the analyzer is spawned once the job hands them back.
+static void launch_analysis_script() {
+    if (analysis_running()) return; // one run at a time
+    analysis = AnalysisRun();
+    analysis.command = analyzer_command();
+    analysis.started = time(nullptr);
+    analysis.state = AnalysisState::Running;
+    uint64_t run = ++analysisRunId;
+    jobPool.submit([run, in = snapshot_analysis_input()]() mutable {
+        collect_analysis_files(in);
+        post_to_ui([run, in = std::move(in)]() mutable { start_analyzer(run, std::move(in)); });
+    }, JobPriority::Low);
+}
+
+static void drawAnalysisWindow(bool* open) {
+    ImGui::SetNextWindowSize(ImVec2(620, 420), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Analysis###analysis_window", open)) { ImGui::End(); return; }
+
+    const char* stateLabel = "idle";
+    switch (analysis.state) {
+    case AnalysisState::Idle: stateLabel = "idle"; break;
+    case AnalysisState::Running: stateLabel = "running"; break;
+    case AnalysisState::Succeeded: stateLabel = "done"; break;
+    case AnalysisState::Failed: stateLabel = "failed"; break;
+    case AnalysisState::Cancelled: stateLabel = "cancelled"; break;
+    case AnalysisState::TimedOut: stateLabel = "timed out"; break;
+    }
+    time_t end = analysis_running() ? time(nullptr) : analysis.finished;
+    ImGui::Text("Command: %s", analysis.command.empty() ? analyzer_command().c_str() : analysis.command.c_str());
+    ImGui::Text("Status: %s", stateLabel);
+    if (analysis.started) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(%s elapsed, timeout %ds)", format_duration_seconds(end - analysis.started).c_str(), ANALYSIS_TIMEOUT_SECONDS);
+    }
+    if (analysis_running()) {
+        if (ImGui::Button("Cancel###btn_analysis_cancel")) cancel_analysis();
+    } else {
+        if (ImGui::Button("Run Again###btn_analysis_rerun")) launch_analysis_script();
+    }
+    ImGui::Separator();
+    ImGui::BeginChild("analysis_output", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
+    if (analysis.output.empty()) ImGui::TextDisabled(analysis_running() ? "(waiting for output...)" : "(no output)");
+    else ImGui::TextUnformatted(analysis.output.data(), analysis.output.data() + analysis.output.size());
+    if (!analysis.errors.empty()) {
+        ImGui::Separator();
+        ImGui::TextDisabled("stderr (not saved):");
+        ImGui::TextUnformatted(analysis.errors.data(), analysis.errors.data() + analysis.errors.size());
+    }
+    if (analysis_running() && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) ImGui::SetScrollHereY(1.0f);
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+// ----------------------- ImGui theme & helpers ----------------------------
+static void ApplyGrayTheme() {
+    ImGuiStyle &style = ImGui::GetStyle();
+    style.WindowRounding = 6.0f;
+    style.FrameRounding = 4.0f;
+    style.GrabRounding = 4.0f;
+    style.WindowBorderSize = 1.0f;
+    style.FrameBorderSize = 1.0f;
+    style.ChildBorderSize = 1.0f;
+    style.PopupBorderSize = 1.0f;
+
+    ImVec4 bg     = ImVec4(0.05f,0.05f,0.06f,1.0f);
+    ImVec4 bgAlt  = ImVec4(0.09f,0.09f,0.10f,1.0f);
+    ImVec4 pane   = ImVec4(0.12f,0.12f,0.13f,1.0f);
+    ImVec4 text   = ImVec4(0.92f,0.92f,0.93f,1.0f);
+    ImVec4 accent = ImVec4(0.20f,0.55f,0.90f,1.0f);
+    ImVec4 border = ImVec4(0.13f,0.13f,0.14f,1.0f);
+
+    style.Colors[ImGuiCol_WindowBg]             = bg;
+    style.Colors[ImGuiCol_ChildBg]              = bgAlt;
+    style.Colors[ImGuiCol_FrameBg]              = pane;
+    style.Colors[ImGuiCol_FrameBgHovered]       = ImVec4(0.18f,0.18f,0.2f,1.0f);
+    style.Colors[ImGuiCol_FrameBgActive]        = ImVec4(0.22f,0.22f,0.24f,1.0f);
+    style.Colors[ImGuiCol_TitleBg]              = bg;
+    style.Colors[ImGuiCol_TitleBgActive]        = bg;
+    style.Colors[ImGuiCol_MenuBarBg]            = bgAlt;
+    style.Colors[ImGuiCol_Header]               = pane;
+    style.Colors[ImGuiCol_HeaderHovered]        = ImVec4(0.16f,0.16f,0.18f,1.0f);
+    style.Colors[ImGuiCol_Button]               = ImVec4(0.14f,0.14f,0.16f,1.0f);
+    style.Colors[ImGuiCol_ButtonHovered]        = accent;
+    style.Colors[ImGuiCol_ButtonActive]         = ImVec4(accent.x*0.9f, accent.y*0.9f, accent.z*0.9f, 1.0f);
+    style.Colors[ImGuiCol_Text]                 = text;
+    style.Colors[ImGuiCol_TextDisabled]         = ImVec4(0.6f,0.6f,0.62f,1.0f);
+    style.Colors[ImGuiCol_Border]               = border;
+    style.Colors[ImGuiCol_ScrollbarBg]          = bgAlt;
+    style.Colors[ImGuiCol_ScrollbarGrab]        = pane;
+    style.Colors[ImGuiCol_PopupBg]              = bgAlt;
+}
+
+// ----------------------- Forwarding callbacks -----------------------------
+static GLFWmousebuttonfun prev_mousebutton_cb = nullptr;
+static GLFWscrollfun prev_scroll_cb = nullptr;
+static GLFWkeyfun prev_key_cb = nullptr;
+static GLFWcharfun prev_char_cb = nullptr;
+static GLFWcursorposfun prev_cursorpos_cb = nullptr;
+static GLFWcursorenterfun prev_cursorenter_cb = nullptr;
+
+static void forward_mousebutton_cb(GLFWwindow* w, int button, int action, int mods) {
+    ImGui_ImplGlfw_MouseButtonCallback(w, button, action, mods);
+    if (prev_mousebutton_cb) prev_mousebutton_cb(w, button, action, mods);
+}
+static void forward_scroll_cb(GLFWwindow* w, double xoffset, double yoffset) {
+    ImGui_ImplGlfw_ScrollCallback(w, xoffset, yoffset);
+    if (prev_scroll_cb) prev_scroll_cb(w, xoffset, yoffset);
+}
+static void forward_key_cb(GLFWwindow* w, int key, int scancode, int action, int mods) {
+    ImGui_ImplGlfw_KeyCallback(w, key, scancode, action, mods);
+    if (prev_key_cb) prev_key_cb(w, key, scancode, action, mods);
+}
+static void forward_char_cb(GLFWwindow* w, unsigned int c) {
+    ImGui_ImplGlfw_CharCallback(w, c);
+    if (prev_char_cb) prev_char_cb(w, c);
+}
+static void forward_cursorpos_cb(GLFWwindow* w, double xpos, double ypos) {
+    ImGui_ImplGlfw_CursorPosCallback(w, xpos, ypos);
+    if (prev_cursorpos_cb) prev_cursorpos_cb(w, xpos, ypos);
+}
+static void forward_cursorenter_cb(GLFWwindow* w, int entered) {
+    ImGui_ImplGlfw_CursorEnterCallback(w, entered);
+    if (prev_cursorenter_cb) prev_cursorenter_cb(w, entered);
+}
+static void InstallForwardingCallbacks(GLFWwindow* window) {
+    prev_mousebutton_cb = glfwSetMouseButtonCallback(window, forward_mousebutton_cb);
+    prev_scroll_cb = glfwSetScrollCallback(window, forward_scroll_cb);
+    prev_key_cb = glfwSetKeyCallback(window, forward_key_cb);
+    prev_char_cb = glfwSetCharCallback(window, forward_char_cb);
+    prev_cursorpos_cb = glfwSetCursorPosCallback(window, forward_cursorpos_cb);
+    prev_cursorenter_cb = glfwSetCursorEnterCallback(window, forward_cursorenter_cb);
+}
+
+// ----------------------- UI helpers --------------------------------------
+static std::string makeButtonLabel(const std::string &visible, const std::string &uniqueId) {
+    return visible + "###" + uniqueId;
+}
+
+// One log line drawn straight into the window's draw list in the entry's precomputed
+// style (bold is a second pass offset by a pixel); no style stack, no type lookups.
+static void drawLogRow(const DailyLog &d) {
+    const LogStyle &st = logStyles[d.style];
+    std::string line = human_log_line(d.type.c_str(), d.text, d.ts);
+    if (st.icon[0]) line = std::string(st.icon) + " " + line;
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    ImVec2 size = ImGui::CalcTextSize(line.c_str(), line.c_str() + line.size());
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    dl->AddText(pos, st.color, line.c_str(), line.c_str() + line.size());
+    if (st.bold) {
+        dl->AddText(ImVec2(pos.x + 1.0f, pos.y), st.color, line.c_str(), line.c_str() + line.size());
+        size.x += 1.0f;
+    }
+    ImGui::Dummy(size);
+}
+
+static void removeTaskAndChildren(int idx)
+{
+    // Safety
+    if (idx < 0 || idx >= (int)tasks.size()) return;
+    if (instance_forward("TASK_REMOVE " + std::to_string(idx) + ipc_task_precondition(idx))) return;
+
+    // First remove children (iterate backwards so erasures don't invalidate earlier indices)
+    for (int i = (int)tasks.size() - 1; i >= 0; --i) {
+        if (tasks[i].parent == idx) {
+            removeTaskAndChildren(i);
+        }
+    }
+
+    // Log removal (optional)
+    append_daily_log("TASK_REMOVE", std::string("Removed task: ") + tasks[idx].name);
+
+    // Erase the task. After erasing an element, indices > idx shift down by 1 and
+    // erase_task_at updates parent references so they still point to the correct tasks.
+    WalRecord r; r.op = WalOp::TaskRemove; r.index = idx;
+    wal_commit(r);
+
+    // Persist
+    save_tasks();
+}
+
+// Add Task parent picker. Labels ("3: name") are built only while the combo is open and
+// kept until tasks_version moves; the type-ahead filter narrows them to `matches`.
+struct ParentPicker {
+    uint64_t version = (uint64_t)-1;
+    std::vector<std::string> labels; // labels[i] describes tasks[i]
+    std::vector<std::string> lower;  // lowercased labels, for filtering
+    char filter[64] = "";
+    std::string lastFilter;
+    uint64_t matchesVersion = (uint64_t)-1;
+    std::vector<int> matches;        // task indices passing the filter
+    int previewIdx = -2;
+    uint64_t previewVersion = (uint64_t)-1;
+    std::string preview;
+};
+static ParentPicker parentPicker;
+
+static std::string task_picker_label(int i) {
+    return std::to_string(i) + ": " + tasks[i].name;
+}
+static const char* parent_picker_preview() {
+    ParentPicker &pp = parentPicker;
+    if (pp.previewIdx != new_task_parent_idx || pp.previewVersion != tasks_version) {
+        pp.previewIdx = new_task_parent_idx;
+        pp.previewVersion = tasks_version;
+        pp.preview = (new_task_parent_idx >= 0 && new_task_parent_idx < (int)tasks.size()) ? task_picker_label(new_task_parent_idx) : "(none)";
+    }
+    return pp.preview.c_str();
+}
+// Called between BeginCombo/EndCombo only.
+static void drawParentPickerItems() {
+    ParentPicker &pp = parentPicker;
+    if (pp.version != tasks_version) {
+        pp.version = tasks_version;
+        pp.labels.resize(tasks.size());
+        pp.lower.resize(tasks.size());
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            pp.labels[i] = task_picker_label((int)i);
+            pp.lower[i] = to_lower_ascii(pp.labels[i]);
+        }
+    }
+    if (ImGui::IsWindowAppearing()) {
+        pp.filter[0] = '\0';
+        ImGui::SetKeyboardFocusHere();
+    }
+    ImGui::SetNextItemWidth(-1);
+    ImGui::InputTextWithHint("###input_parent_filter", "type to filter", pp.filter, sizeof(pp.filter));
+    if (pp.matchesVersion != tasks_version || pp.lastFilter != pp.filter) {
+        pp.matchesVersion = tasks_version;
+        pp.lastFilter = pp.filter;
+        std::string needle = to_lower_ascii(pp.lastFilter);
+        pp.matches.clear();
+        for (size_t i = 0; i < pp.lower.size(); ++i)
+            if (needle.empty() || pp.lower[i].find(needle) != std::string::npos) pp.matches.push_back((int)i);
+    }
+    if (pp.lastFilter.empty() && ImGui::Selectable("(none)", new_task_parent_idx == -1)) new_task_parent_idx = -1;
+    ImGuiListClipper clipper;
+    clipper.Begin((int)pp.matches.size());
+    while (clipper.Step())
+    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+        int idx = pp.matches[row];
+        bool sel = (idx == new_task_parent_idx);
+        ImGui::PushID(idx);
+        if (ImGui::Selectable(pp.labels[idx].c_str(), sel)) new_task_parent_idx = idx;
+        ImGui::PopID();
+    }
+    clipper.End();
+}
+
+static void drawTasksRecursive(int idx, int depth = 0)
+{
+    // Safety
+    if (idx < 0 || idx >= (int)tasks.size()) return;
+
+    ImGui::PushID(idx);
+
+    // Checkbox first (first-column behavior)
+    bool done = tasks[idx].done;
+    if (ImGui::Checkbox("##task_done", &done)) set_task_done(idx, done);
+
+    // Simple delete "X" right after the checkbox
+    ImGui::SameLine();
+    {
+        ImGui::PushStyleColor(ImGuiCol_Button,        ImVec4(0.70f, 0.12f, 0.12f, 1.0f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.90f, 0.18f, 0.18f, 1.0f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive,  ImVec4(0.80f, 0.14f, 0.14f, 1.0f));
+
+        if (ImGui::SmallButton("X###del")) { // unique per task through PushID(idx)
+            removeTaskAndChildren(idx);
+            ImGui::PopStyleColor(3); // pop the three pushed colors
+            ImGui::PopID();          // balance the earlier PushID(idx)
+            return;
+        }
+
+        ImGui::PopStyleColor(3); // pop the three pushed colors for the non-click path
+    }
+
+    // Place tree node to the right of the checkbox+X
+    ImGui::SameLine();
+
+    // Indent the tree node according to depth so arrows/labels line up correctly.
+    const float indentPerLevel = 18.0f;
+    if (depth > 0) ImGui::Indent(depth * indentPerLevel);
+
+    // Determine if this node has children
+    bool hasChild = false;
+    for (int i = 0; i < (int)tasks.size(); ++i) {
+        if (tasks[i].parent == idx) { hasChild = true; break; }
+    }
+
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
+    if (!hasChild) flags |= ImGuiTreeNodeFlags_Leaf;
+
+    // Draw the tree node label
+    bool opened = ImGui::TreeNodeEx((void*)(intptr_t)idx, flags, "%s", tasks[idx].name.c_str());
+
+    // Unindent immediately after drawing the node so children are indented relative to the node.
+    if (depth > 0) ImGui::Unindent(depth * indentPerLevel);
+
+    // If expanded, recurse into children
+    if (opened) {
+        for (int i = 0; i < (int)tasks.size(); ++i) {
+            if (tasks[i].parent == idx) {
+                drawTasksRecursive(i, depth + 1);
+            }
+        }
+        ImGui::TreePop();
+    }
+
+    ImGui::PopID();
+}
+
+// ----------------------- Profiler -----------------------------------------
+// Per-frame CPU time and UI-thread allocations, recorded around each frame
+// (NewFrame .. Render) by frame_profile_begin/end and shown by View > Profiler.
+static const int kProfileFrames = 240;
+struct FrameProfile {
+    float ms[kProfileFrames] = {};
+    float allocs[kProfileFrames] = {};
+    int next = 0;
+    int count = 0;
+    std::chrono::steady_clock::time_point start;
+    AllocCounters startCounters;
+    uint64_t lastAllocs = 0;
+    uint64_t lastBytes = 0;
+};
+static FrameProfile frameProfile;
+static bool showProfilerWindow = false;
+
+static void frame_profile_begin() {
+    frameProfile.start = std::chrono::steady_clock::now();
+    frameProfile.startCounters = tlAllocCounters;
+}
+static void frame_profile_end() {
+    FrameProfile &fp = frameProfile;
+    fp.lastAllocs = tlAllocCounters.allocs - fp.startCounters.allocs;
+    fp.lastBytes = tlAllocCounters.bytes - fp.startCounters.bytes;
+    fp.ms[fp.next] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - fp.start).count();
+    fp.allocs[fp.next] = (float)fp.lastAllocs;
+    fp.next = (fp.next + 1) % kProfileFrames;
+    if (fp.count < kProfileFrames) ++fp.count;
+}
+
+static void drawProfilerWindow(bool* open) {
+    ImGui::SetNextWindowSize(ImVec2(420, 300), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler", open)) { ImGui::End(); return; }
+    const FrameProfile &fp = frameProfile;
+    float sumMs = 0.0f, maxMs = 0.0f, sumAllocs = 0.0f, maxAllocs = 0.0f;
+    for (int i = 0; i < fp.count; ++i) {
+        sumMs += fp.ms[i]; maxMs = std::max(maxMs, fp.ms[i]);
+        sumAllocs += fp.allocs[i]; maxAllocs = std::max(maxAllocs, fp.allocs[i]);
+    }
+    int n = std::max(1, fp.count);
+    ImGui::Text("UI frame: %.2f ms avg, %.2f ms max (last %d frames)", sumMs / n, maxMs, fp.count);
+    ImGui::PlotLines("###plot_frame_ms", fp.ms, fp.count, fp.count == kProfileFrames ? fp.next : 0, "ms", 0.0f, FLT_MAX, ImVec2(-1, 60));
+    ImGui::Separator();
+    bool counting = allocCountingEnabled.load();
+    if (ImGui::Checkbox("Count allocations###chk_count_allocs", &counting)) allocCountingEnabled.store(counting);
+    if (counting) {
+        ImGui::Text("UI thread: %llu allocations (%llu bytes) last frame; %.1f avg, %.0f max",
+                    (unsigned long long)fp.lastAllocs, (unsigned long long)fp.lastBytes, sumAllocs / n, maxAllocs);
+        ImGui::PlotHistogram("###plot_frame_allocs", fp.allocs, fp.count, fp.count == kProfileFrames ? fp.next : 0, "allocs", 0.0f, FLT_MAX, ImVec2(-1, 60));
+        ImGui::Text("Totals: %llu allocs, %llu frees", (unsigned long long)tlAllocCounters.allocs, (unsigned long long)tlAllocCounters.frees);
+    } else {
+        ImGui::TextDisabled("(allocation counting is off)");
+    }
+    ImGui::End();
+}
+
+// ----------------------- Stats panel --------------------------------------
+// Charts are drawn from the aggregate store. Plot inputs are cached and only
+// rebuilt when agg_version, the selected range or the current day changes, so a
+// frame costs O(days in range) draw calls and nothing else.
+struct StatsCache {
+    uint64_t version = ~0ull;
+    int32_t lastDay = 0;
+    int rangeDays = 0;
+    std::vector<float> trackedHours; // per day, oldest first
+    std::vector<float> breakHours;   // per day, oldest first
+    std::vector<float> weeklyTrackedHours;
+    float maxDayHours = 1.0f;
+    float breakTypeHours[kBreakTypeSlots] = {};
+    float hourlyCoverage[24] = {};   // HOURLY entries by hour of day over the range
+    AggregateTotals totals;
+};
+static StatsCache statsCache;
+static int statsRangeDays = 14;
+
+static void rebuild_stats_cache(int32_t today, int rangeDays) {
+    StatsCache &c = statsCache;
+    c.version = agg_version;
+    c.lastDay = today;
+    c.rangeDays = rangeDays;
+    c.trackedHours.assign(rangeDays, 0.0f);
+    c.breakHours.assign(rangeDays, 0.0f);
+    c.weeklyTrackedHours.assign((rangeDays + 6) / 7, 0.0f);
+    std::fill(std::begin(c.breakTypeHours), std::end(c.breakTypeHours), 0.0f);
+    std::fill(std::begin(c.hourlyCoverage), std::end(c.hourlyCoverage), 0.0f);
+
+    int32_t first = today - rangeDays + 1;
+    auto it = std::lower_bound(dayAggregates.begin(), dayAggregates.end(), first,
+                               [](const DayAggregate &a, int32_t d) { return a.day < d; });
+    for (; it != dayAggregates.end() && it->day <= today; ++it) {
+        int slot = it->day - first;
+        for (int h = 0; h < 24; ++h) {
+            const HourBucket &hb = it->hours[h];
+            c.trackedHours[slot] += hb.tracked_seconds / 3600.0f;
+            for (int s = 0; s < kBreakTypeSlots; ++s) {
+                c.breakHours[slot] += hb.break_seconds[s] / 3600.0f;
+                c.breakTypeHours[s] += hb.break_seconds[s] / 3600.0f;
+            }
+            c.hourlyCoverage[h] += (float)hb.hourly_entries;
+        }
+    }
+    // Weeks are counted back from today so the last bar is always the current 7 days
+    for (int d = 0; d < rangeDays; ++d)
+        c.weeklyTrackedHours[(int)c.weeklyTrackedHours.size() - 1 - (rangeDays - 1 - d) / 7] += c.trackedHours[d];
+    c.maxDayHours = 1.0f;
+    for (int d = 0; d < rangeDays; ++d) c.maxDayHours = std::max(c.maxDayHours, c.trackedHours[d] + c.breakHours[d]);
+    c.totals = agg_totals(first, today);
+}
+
+static void drawStatsWindow(bool* open) {
+    ImGui::SetNextWindowSize(ImVec2(640, 560), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Stats###stats_window", open)) { ImGui::End(); return; }
+
+    ImGui::Text("Range:");
+    ImGui::SameLine(); ImGui::RadioButton("14 days###stats_r14", &statsRangeDays, 14);
+    ImGui::SameLine(); ImGui::RadioButton("30 days###stats_r30", &statsRangeDays, 30);
+    ImGui::SameLine(); ImGui::RadioButton("90 days###stats_r90", &statsRangeDays, 90);
+
+    time_t nowt = time(nullptr);
+    int32_t today = local_day_index(nowt);
+    if (statsCache.version != agg_version || statsCache.lastDay != today || statsCache.rangeDays != statsRangeDays)
+        rebuild_stats_cache(today, statsRangeDays);
+    const StatsCache &c = statsCache;
+
+    // The running interval is not in the aggregates until the timer pauses; add it to today only
+    float liveHours = (tracking_start_time == 0) ? 0.0f : (float)(nowt - tracking_start_time) / 3600.0f;
+
+    ImGui::Separator();
+    ImGui::Text("Tracked: %s   Breaks: %s   Hourly entries: %u   Tasks completed: %u",
+                format_duration_seconds((time_t)c.totals.tracked_seconds + (time_t)(liveHours * 3600.0f)).c_str(),
+                format_duration_seconds((time_t)c.totals.total_break_seconds()).c_str(),
+                c.totals.hourly_entries, c.totals.tasks_completed);
+
+    // Daily stacked bars: tracked (green) below break time (red)
+    ImGui::Text("Daily tracked vs break hours (oldest -> today)");
+    {
+        const float chartH = 140.0f;
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        float width = ImGui::GetContentRegionAvail().x;
+        ImDrawList* dl = ImGui::GetWindowDrawList();
+        dl->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + chartH), IM_COL32(20, 20, 24, 255));
+        float maxH = std::max(c.maxDayHours, c.trackedHours.empty() ? 1.0f : c.trackedHours.back() + c.breakHours.back() + liveHours);
+        float barW = width / (float)c.rangeDays;
+        for (int d = 0; d < c.rangeDays; ++d) {
+            float tracked = c.trackedHours[d] + (d == c.rangeDays - 1 ? liveHours : 0.0f);
+            float x0 = origin.x + d * barW + 1.0f, x1 = origin.x + (d + 1) * barW - 1.0f;
+            float yBase = origin.y + chartH;
+            float yTracked = yBase - chartH * (tracked / maxH);
+            float yBreak = yTracked - chartH * (c.breakHours[d] / maxH);
+            if (tracked > 0.0f) dl->AddRectFilled(ImVec2(x0, yTracked), ImVec2(x1, yBase), IM_COL32(40, 160, 80, 255));
+            if (c.breakHours[d] > 0.0f) dl->AddRectFilled(ImVec2(x0, yBreak), ImVec2(x1, yTracked), IM_COL32(200, 80, 80, 255));
+        }
+        ImGui::Dummy(ImVec2(width, chartH));
+        ImGui::TextDisabled("max %.1fh/day", maxH);
+    }
+
+    ImGui::Text("Weekly tracked hours");
+    ImGui::PlotHistogram("##stats_weekly", c.weeklyTrackedHours.data(), (int)c.weeklyTrackedHours.size(), 0, nullptr,
+                         0.0f, FLT_MAX, ImVec2(-1, 70));
+
+    ImGui::Text("Break time by type (hours)");
+    if (ImGui::BeginTable("tbl_stats_break_types", 2, ImGuiTableFlags_SizingStretchProp)) {
+        float maxType = 0.0f;
+        for (float v : c.breakTypeHours) maxType = std::max(maxType, v);
+        for (int s = 0; s < kBreakTypeSlots; ++s) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(s < (int)kBreakTypes.size() ? kBreakTypes[s].c_str() : "Other");
+            ImGui::TableNextColumn();
+            char overlay[32]; snprintf(overlay, sizeof(overlay), "%.2fh", c.breakTypeHours[s]);
+            ImGui::ProgressBar(maxType > 0.0f ? c.breakTypeHours[s] / maxType : 0.0f, ImVec2(-1, 0), overlay);
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::Text("Hourly log coverage (entries by hour of day)");
+    ImGui::PlotHistogram("##stats_hourly_cov", c.hourlyCoverage, 24, 0, "00h .. 23h", 0.0f, FLT_MAX, ImVec2(-1, 80));
+
+    ImGui::End();
+}
+
+// ----------------------- Main window --------------------------------------
+// Builds one frame of UI, between ImGui::NewFrame() and ImGui::Render(). Has no
+// platform or GL dependencies, so it can also be driven without a window.
+// Quitting (menu or End Day) is signalled through request_quit.
+static bool showStatsWindow = false;
+
+static void drawFrameUI() {
+    poll_analysis();
+    ipc_poll();
+    instance_poll();
+    run_ui_completions();
+    api_publish_if_changed();
+    status_page_heartbeat();
+
+    // Open hourly popup if requested and play alert
+    if (requestHourlyPopup) {
+        ImGui::OpenPopup("Hourly Log");
+        play_alert_async();
+        requestHourlyPopup = false;
+    }
+
+    // Main window spanning the work area
+    ImGuiViewport* vp = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(vp->WorkPos);
+    ImGui::SetNextWindowSize(vp->WorkSize);
+    ImGuiWindowFlags mainFlags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize
+                               | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_MenuBar;
+    ImGui::Begin("MainWindow", nullptr, mainFlags);
+
+    // Menu bar
+    if (ImGui::BeginMenuBar()) {
+        if (ImGui::BeginMenu("File")) {
+            // Secondary windows leave the files to the primary
+            if (ImGui::MenuItem("Save Tasks", nullptr, false, !instance_is_secondary())) save_tasks();
+            if (ImGui::MenuItem("Save Daily Logs", nullptr, false, !instance_is_secondary())) {
+                StorageBackend &st = storage_backend();
+                st.begin_batch();
+                for (const auto &d : dailyLogs) st.append_log(d.ts, d.type, d.text);
+                st.end_batch();
+            }
+            if (ImGui::MenuItem("Quit")) request_quit.store(true);
+            ImGui::EndMenu();
+        }
+        if (ImGui::BeginMenu("View")) {
+            ImGui::MenuItem("Stats", nullptr, &showStatsWindow);
+            ImGui::MenuItem("Analysis", nullptr, &showAnalysisWindow);
+            ImGui::MenuItem("Profiler", nullptr, &showProfilerWindow);
+            ImGui::Separator();
+            if (ImGui::MenuItem("Reload log styles")) reload_log_styles();
+            ImGui::EndMenu();
+        }
+        ImGui::EndMenuBar();
+    }
+    
+    if (instance_is_secondary()) ImGui::TextColored(ImVec4(0.95f,0.75f,0.35f,1.0f), "%s", instance_banner());
+
+    // Toolbar (Test, Random, Exports, Clear All)
+    
+
+    // Top toolbar: Test hourly, Random break, Export statuses, Export weekly logs, Export hourly (today)
+    // Test Hourly Popup (neutral)
+    {
+        ImVec4 btn = ImVec4(0.20f,0.20f,0.22f,1.0f);
+        ImVec4 btnH = ImVec4(0.26f,0.26f,0.28f,1.0f);
+        ImVec4 btnA = ImVec4(0.22f,0.22f,0.24f,1.0f);
+        ImGui::PushStyleColor(ImGuiCol_Button, btn);
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, btnH);
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive, btnA);
+        if (ImGui::Button("Test Hourly Popup###btn_test_hourly_popup")) requestHourlyPopup = true;
+        ImGui::PopStyleColor(3);
+    }
+    ImGui::SameLine();
+
+    // End Day (orange)
+    {
+        ImVec4 b = ImVec4(0.9f,0.45f,0.12f,1.0f);
+        ImVec4 bh = ImVec4(0.95f,0.60f,0.20f,1.0f);
+        ImVec4 ba = ImVec4(0.85f,0.40f,0.10f,1.0f);
+        ImGui::PushStyleColor(ImGuiCol_Button, b);
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
+        ImGui::BeginDisabled(instance_is_secondary());
+        if (ImGui::Button("End Day###btn_end_day")) ImGui::OpenPopup("Confirm End Day");
+        ImGui::EndDisabled();
+        ImGui::PopStyleColor(3);
+
+        if (ImGui::BeginPopupModal("Confirm End Day", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+            if (ImGui::IsWindowAppearing()) ImGui::SetKeyboardFocusHere();
+            ImGui::TextWrapped("This will end any active breaks, pause the session timer, export logs/status and reset tracking for the next day. Proceed?");
+            ImGui::Separator();
+            if (ImGui::Button("Yes - End Day")) {
+                end_day_action();
+                ImGui::CloseCurrentPopup();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel")) {
+                ImGui::CloseCurrentPopup();
+            }
+            ImGui::EndPopup();
+        }
+    }
+    ImGui::SameLine();
+
+    // Random Break (red)
+    {
+        ImVec4 b = ImVec4(0.45f,0.20f,0.20f,1.0f);
+        ImVec4 bh = ImVec4(0.70f,0.22f,0.22f,1.0f);
+        ImVec4 ba = ImVec4(0.60f,0.18f,0.18f,1.0f);
+        ImGui::PushStyleColor(ImGuiCol_Button, b);
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
+        if (ImGui::Button("Random Break###btn_random_break")) add_random_break();
+        ImGui::PopStyleColor(3);
+    }
+    ImGui::SameLine();
+
+    // Export Daily Status (yellow)
+    {
+        ImVec4 b = ImVec4(0.60f,0.55f,0.20f,1.0f);
+        ImVec4 bh = ImVec4(0.85f,0.78f,0.22f,1.0f);
+        ImVec4 ba = ImVec4(0.70f,0.65f,0.18f,1.0f);
+        ImGui::PushStyleColor(ImGuiCol_Button, b);
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
+        ImGui::BeginDisabled(instance_is_secondary());
+        if (ImGui::Button("Export Daily Status (file)###btn_export_daily_status_top")) {
+            std::string path = export_text_to_file("daily_status_export", dailyStatusText);
+            if (!path.empty()) append_daily_log("EXPORT", std::string("Exported daily status to ") + path);
+        }
+        ImGui::EndDisabled();
+        ImGui::PopStyleColor(3);
+    }
+    ImGui::SameLine();
+
+    // Export Weekly Status (green)
+    {
+        ImVec4 b = ImVec4(0.20f,0.55f,0.30f,1.0f);
+        ImVec4 bh = ImVec4(0.22f,0.78f,0.40f,1.0f);
+        ImVec4 ba = ImVec4(0.18f,0.68f,0.28f,1.0f);
+        ImGui::PushStyleColor(ImGuiCol_Button, b);
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
+        ImGui::BeginDisabled(instance_is_secondary());
+        if (ImGui::Button("Export Weekly Status (file)###btn_export_weekly_status_top")) {
+            std::string path = export_text_to_file("weekly_status_export", weeklyStatusText);
+            if (!path.empty()) append_daily_log("EXPORT", std::string("Exported weekly status to ") + path);
+        }
+        ImGui::EndDisabled();
+        ImGui::PopStyleColor(3);
+    }
+    ImGui::SameLine();
+
+    // Export Weekly Logs (purple) - includes daily status & hourly logs (LLM-friendly section)
+    {
+        ImVec4 b = ImVec4(0.45f,0.30f,0.6f,1.0f);
+        ImVec4 bh = ImVec4(0.65f,0.38f,0.85f,1.0f);
+        ImVec4 ba = ImVec4(0.55f,0.34f,0.72f,1.0f);
+        ImGui::PushStyleColor(ImGuiCol_Button, b);
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
+        ImGui::BeginDisabled(instance_is_secondary());
+        if (ImGui::Button("Export Weekly Logs (file)###btn_export_weekly_logs_top")) {
+            export_weekly_logs_file();
+        }
+        ImGui::EndDisabled();
+        ImGui::PopStyleColor(3);
+    }
+    ImGui::SameLine();
+    // Analyze Productivity (AI)
+    {
+        ImVec4 b = ImVec4(0.12f,0.55f,0.40f,1.0f);
+        ImVec4 bh = ImVec4(0.18f,0.75f,0.55f,1.0f);
+        ImVec4 ba = ImVec4(0.10f,0.45f,0.32f,1.0f);
+        ImGui::PushStyleColor(ImGuiCol_Button, b);
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
+        ImGui::BeginDisabled(analysis_running() || instance_is_secondary());
+        if (ImGui::Button(analysis_running() ? "Analyzing...###btn_analyze_ai" : "Analyze Productivity (AI)###btn_analyze_ai")) {
+            launch_analysis_script();
+        }
+        ImGui::EndDisabled();
+        ImGui::PopStyleColor(3);
+    }
+    ImGui::SameLine();
+
+    {
+        ImVec4 b  = ImVec4(0.7f, 0.12f, 0.12f, 1.0f);
+        ImVec4 bh = ImVec4(0.9f, 0.18f, 0.18f, 1.0f);
+        ImVec4 ba = ImVec4(0.8f, 0.14f, 0.14f, 1.0f);
+
+        ImGui::PushStyleColor(ImGuiCol_Button,         b);
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered,  bh);
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive,   ba);
+
+        ImGui::BeginDisabled(instance_is_secondary());
+        if (ImGui::Button("Clear All###btn_clear_all"))
+            ImGui::OpenPopup("Confirm Clear All");
+        ImGui::EndDisabled();
+
+        // Always pop the three colors we pushed above (do this regardless of whether the button was pressed)
+        ImGui::PopStyleColor(3);
+
+        // Confirmation modal (opened by ImGui::OpenPopup above)
+        if (ImGui::BeginPopupModal("Confirm Clear All", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+        {
+            // When the window appears, set default focus on the "Yes" button for quicker keyboard confirmation
+            if (ImGui::IsWindowAppearing())
+                ImGui::SetKeyboardFocusHere();
+
+            ImGui::TextWrapped(
+                "This will delete all persisted logs, tasks and status files and CLEAR in-memory data.\n\n"
+                "This action cannot be undone. Do you want to proceed?"
+            );
+            ImGui::Separator();
+
+            // Confirm
+            if (ImGui::Button("Yes - Clear All"))
+            {
+                // clear in-memory + persisted state
+                clearAllData();
+
+                ImGui::CloseCurrentPopup();
+            }
+
+            ImGui::SameLine();
+
+            // Cancel
+            if (ImGui::Button("Cancel"))
+                ImGui::CloseCurrentPopup();
+
+            ImGui::EndPopup();
+        }
+    }
+    ImGui::Separator();
+
+    // Layout: left child (logs + tasks side-by-side) + right child (controls)
+    float availW = ImGui::GetContentRegionAvail().x;
+    float leftWidth = availW * 0.62f;
+    float rightWidth = availW - leftWidth - ImGui::GetStyle().ItemSpacing.x;
+
+    ImGui::BeginChild("left_panel", ImVec2(leftWidth, 0), true);
+        float half = (leftWidth - ImGui::GetStyle().ItemSpacing.x) * 0.5f;
+        ImGui::BeginChild("logs_col", ImVec2(half, 320), true, ImGuiWindowFlags_None);
+            ImGui::Text("Daily Logs:");
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(100);
+            ImGui::Combo("###combo_search_mode", &searchMode, "Words\0Substring\0Fuzzy\0");
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(-1);
+            ImGui::InputTextWithHint("###input_log_search", searchMode == SearchWords ? "search: words, prefix*, \"phrase\"" : "search: any part of a line", searchQueryText, sizeof(searchQueryText));
+            if (searchQueryText[0] == '\0') {
+                // Filters for the plain log list
+                ImGui::SetNextItemWidth(120);
+                if (ImGui::Combo("###combo_log_range", &logFilter.range, "All dates\0Today\0Last 7 days\0Last 30 days\0Custom\0"))
+                    logView.dirty = true;
+                if (logFilter.range == LogRangeCustom) {
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(90);
+                    if (ImGui::InputTextWithHint("###input_log_from", "from Y-M-D", logFilter.customFrom, sizeof(logFilter.customFrom))) logView.dirty = true;
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(90);
+                    if (ImGui::InputTextWithHint("###input_log_to", "to Y-M-D", logFilter.customTo, sizeof(logFilter.customTo))) logView.dirty = true;
+                }
+                ImGui::SameLine();
+                std::string typesLabel = logFilter.hiddenTypes.empty() ? std::string("Types") : "Types (" + std::to_string(logFilter.hiddenTypes.size()) + " hidden)";
+                if (ImGui::Button((typesLabel + "###btn_log_types").c_str())) ImGui::OpenPopup("log_types_popup");
+                if (ImGui::BeginPopup("log_types_popup")) {
+                    update_log_view();
+                    if (ImGui::SmallButton("All")) { logFilter.hiddenTypes.clear(); logView.dirty = true; }
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton("None")) {
+                        logFilter.hiddenTypes.clear();
+                        for (const auto &f : logTypeFacets) logFilter.hiddenTypes.push_back(f.type);
+                        logView.dirty = true;
+                    }
+                    ImGui::Separator();
+                    for (size_t t = 0; t < logTypeFacets.size(); ++t) {
+                        const LogTypeFacet &f = logTypeFacets[t];
+                        bool shown = !log_type_hidden(f.type);
+                        uint32_t inRange = t < logView.inRange.size() ? logView.inRange[t] : 0;
+                        std::string label = f.type + " (" + std::to_string(inRange) + ")###facet_" + f.type;
+                        if (ImGui::Checkbox(label.c_str(), &shown)) {
+                            if (shown) logFilter.hiddenTypes.erase(std::find(logFilter.hiddenTypes.begin(), logFilter.hiddenTypes.end(), f.type));
+                            else logFilter.hiddenTypes.push_back(f.type);
+                            logView.dirty = true;
+                        }
+                    }
+                    ImGui::EndPopup();
+                }
+                update_log_view();
+                if (!logView.all) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("%zu of %zu", logView.rows.size(), dailyLogs.size());
+                }
+            }
+            ImGui::Separator();
+            ImGui::BeginChild("logs_list", ImVec2(0, -1), false, ImGuiWindowFlags_HorizontalScrollbar);
+                if (searchQueryText[0] != '\0') {
+                    // Search results: one line per hit, virtualized
+                    refresh_search_results();
+                    ImGui::TextDisabled("%zu match%s (%.2f ms)", searchResults.size(), searchResults.size() == 1 ? "" : "es", searchLastMillis);
+                    if (searchMode != SearchWords) {
+                        ImGui::SameLine();
+                        if (trigramIndex.ready)
+                            ImGui::TextDisabled("- trigram index: %zu trigrams, %.1f MB", trigramIndex.postings.size(), trigram_index_bytes() / (1024.0 * 1024.0));
+                        else
+                            ImGui::TextDisabled("- trigram index building; results appear once it is ready");
+                    }
+                    ImGuiListClipper clipper;
+                    clipper.Begin((int)searchResults.size());
+                    while (clipper.Step())
+                    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                        drawLogRow(dailyLogs[searchResults[row]]);
+                    }
+                    clipper.End();
+                } else if (!dailyLogs.empty()) {
+                    // Filtered view, newest first, virtualized
+                    update_log_view();
+                    int rowCount = logView.all ? (int)dailyLogs.size() : (int)logView.rows.size();
+                    if (rowCount == 0) ImGui::TextDisabled("(no logs match the filters)");
+                    ImGuiListClipper clipper;
+                    clipper.Begin(rowCount);
+                    while (clipper.Step())
+                    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                        int i = rowCount - 1 - row;
+                        drawLogRow(dailyLogs[logView.all ? (uint32_t)i : logView.rows[i]]);
+                    }
+                    clipper.End();
+                } else {
+                    ImGui::TextDisabled("(no logs yet)");
+                }
+            ImGui::EndChild();
+        ImGui::EndChild();
+
+        ImGui::SameLine();
+
+        ImGui::BeginChild("tasks_col", ImVec2(half, 320), true, ImGuiWindowFlags_None);
+        ImGui::Text("Tasks:");
+        ImGui::Separator();
+        ImGui::BeginChild("tasks_list", ImVec2(0, -1), false, ImGuiWindowFlags_None);
+        if (!tasks.empty()) {
+            for (int i = 0; i < (int)tasks.size(); ++i)
+                if (tasks[i].parent == -1)
+                    drawTasksRecursive(i);
+        } else {
+            ImGui::TextDisabled("(no tasks)");
+        }
+        ImGui::EndChild();
+        ImGui::EndChild();
+
+        ImGui::Separator();
+
+        ImGui::Text("Breaks: %d (%d active)", (int)breaks.size(), active_breaks_count());
+        if (!breaks.empty()) {
+            // Scrolling table + clipper: only the visible rows are laid out and formatted
+            float tableH = ImGui::GetContentRegionAvail().y;
+            if (tableH < 160.0f) tableH = 160.0f;
+            if (ImGui::BeginTable("tbl_breaks_left", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, tableH))) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Type", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+                ImGui::TableSetupColumn("Start/End", ImGuiTableColumnFlags_WidthStretch);
+                ImGui::TableSetupColumn("Action", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+                ImGui::TableHeadersRow();
+                ImGuiListClipper clipper;
+                clipper.Begin((int)breaks.size());
+                while (clipper.Step())
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                    int i = (int)breaks.size() - 1 - row; // newest first
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(breaks[i].type.c_str());
+                    ImGui::TableNextColumn();
+                    if (breaks[i].start) {
+                        if (breaks[i].end) ImGui::Text("%s -> %s", format_time_local(breaks[i].start).c_str(), format_time_local(breaks[i].end).c_str());
+                        else ImGui::Text("%s (active)", format_time_local(breaks[i].start).c_str());
+                    } else ImGui::TextUnformatted("(n/a)");
+                    ImGui::TableNextColumn();
+                    if (breaks[i].end == 0) {
+                        char endLabel[64]; snprintf(endLabel, sizeof(endLabel), "End %d###btn_end_%d", i, i);
+                        if (ImGui::Button(endLabel)) { end_break_at(i, time(nullptr)); append_daily_log("BREAK_END", std::string("Ended break: ") + breaks[i].type); }
+                    } else {
+                        char startLabel[64]; snprintf(startLabel, sizeof(startLabel), "Start %d###btn_start_%d", i, i);
+                        if (ImGui::Button(startLabel)) start_break(breaks[i].type);
+                    }
+                }
+                clipper.End();
+                ImGui::EndTable();
+            }
+        } else ImGui::TextDisabled("(no breaks yet)");
+    ImGui::EndChild();
+
+    ImGui::SameLine();
+
+    ImGui::BeginChild("right_panel", ImVec2(rightWidth, 0), true);
+        // Big session timer displayed prominently at the top of the right panel
+        {
+            time_t nowt = time(nullptr);
+            // Compute total tracked seconds (exclude time spent during active breaks)
+            long total_tracked = tracked_seconds_at(nowt);
+            std::string dur = format_duration_seconds(total_tracked);
+            bool running = (tracking_start_time != 0);
+            std::string visible = std::string("Session: ") + dur + (running ? std::string("") : std::string(" (BREAK)"));
+            std::string btnLabel = makeButtonLabel(visible, "session_timer_btn");
+
+            // Running: dark green background, Paused: red background
+            ImVec4 b_run  = ImVec4(0.04f, 0.40f, 0.12f, 1.0f); // dark green
+            ImVec4 bh_run = ImVec4(0.08f, 0.55f, 0.20f, 1.0f);
+            ImVec4 ba_run = ImVec4(0.03f, 0.33f, 0.10f, 1.0f);
+
+            ImVec4 b_paused  = ImVec4(0.85f, 0.12f, 0.12f, 1.0f); // red when paused
+            ImVec4 bh_paused = ImVec4(0.95f, 0.25f, 0.25f, 1.0f);
+            ImVec4 ba_paused = ImVec4(0.75f, 0.10f, 0.10f, 1.0f);
+
+            if (running) {
+                ImGui::PushStyleColor(ImGuiCol_Button, b_run);
+                ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh_run);
+                ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba_run);
+            } else {
+                ImGui::PushStyleColor(ImGuiCol_Button, b_paused);
+                ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh_paused);
+                ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba_paused);
+            }
+
+            // Use black text for the timer label
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.02f, 0.02f, 0.02f, 1.0f));
+
+            // Temporarily increase font scale to make the text very large (timebomb look)
+            ImGuiIO &gio = ImGui::GetIO();
+            float oldScale = gio.FontGlobalScale;
+            gio.FontGlobalScale = oldScale * 2.0f;
+
+            // Use full available width and a taller height to make it visually prominent
+            float availW = ImGui::GetContentRegionAvail().x;
+            ImGui::Button(btnLabel.c_str(), ImVec2(availW, 100.0f));
+
+            // Restore font scale and pop the text color and button colors
+            gio.FontGlobalScale = oldScale;
+            ImGui::PopStyleColor(1); // pop text color
+            ImGui::PopStyleColor(3); // pop button colors
+            ImGui::Spacing();
+        }
+
+        ImGui::Text("Break Controls:");
+        ImGui::Separator();
+        ImGui::SetNextItemWidth(180);
+        if (ImGui::BeginCombo("Break Type###combo_break_types", kBreakTypes[selectedBreakTypeIndex].c_str())) {
+            for (int i = 0; i < (int)kBreakTypes.size(); ++i) {
+                bool sel = (i == selectedBreakTypeIndex);
+                if (ImGui::Selectable(kBreakTypes[i].c_str(), sel)) selectedBreakTypeIndex = i;
+                if (sel) ImGui::SetItemDefaultFocus();
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Start Selected###btn_start_selected_right")) start_break(kBreakTypes[selectedBreakTypeIndex]);
+        ImGui::SameLine();
+        if (ImGui::Button("End Selected###btn_end_selected_right")) end_last_break_of_type(kBreakTypes[selectedBreakTypeIndex]);
+
+        ImGui::Separator();
+        ImGui::Text("Add Task:");
+        ImGui::InputText("Task name###input_task_name_right", newTaskText, sizeof(newTaskText));
+        ImGui::SetNextItemWidth(240);
+        if (ImGui::BeginCombo("Parent###combo_parent_right", parent_picker_preview(), ImGuiComboFlags_HeightLarge)) {
+            drawParentPickerItems();
+            ImGui::EndCombo();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Add Task###btn_add_task_right")) {
+            if (std::strlen(newTaskText)>0) { add_task(std::string(newTaskText), new_task_parent_idx); std::memset(newTaskText,0,sizeof(newTaskText)); new_task_parent_idx=-1; }
+        }
+
+        ImGui::Separator();
+        ImGui::Text("Quick Daily Log:");
+        ImGui::InputText("Quick log###input_quick_log_right", hourlyInputText, sizeof(hourlyInputText));
+        ImGui::SameLine();
+        if (ImGui::Button("Log Now###btn_log_now_right")) {
+            if (std::strlen(hourlyInputText)>0) { append_daily_log("HOURLY", std::string(hourlyInputText)); std::memset(hourlyInputText, 0, sizeof(hourlyInputText)); }
+        }
 
-static void removeTaskAndChildren(int idx)
-{
-    // Safety
-    if (idx < 0 || idx >= (int)tasks.size()) return;
+        ImGui::Separator();
+        ImGui::Text("Daily Status (inline):");
+        ImGui::InputTextMultiline("Daily status###daily_status_inline_right", dailyStatusText, sizeof(dailyStatusText), ImVec2(-1,100));
+        ImGui::SameLine();
+        if (ImGui::Button("Save Daily Status###btn_save_daily_inline_right")) {
+            if (std::strlen(dailyStatusText)>0) { save_daily_status_to_disk_and_log(dailyStatusText); std::memset(dailyStatusText,0,sizeof(dailyStatusText)); }
+        }
+        ImGui::SameLine();
+        ImGui::BeginDisabled(instance_is_secondary());
+        if (ImGui::Button("Export Daily Status (file)###btn_export_daily_status_right")) {
+            std::string p = export_text_to_file("daily_status_export", dailyStatusText);
+            if (!p.empty()) append_daily_log("EXPORT", std::string("Exported daily status to ") + p);
+        }
+        ImGui::EndDisabled();
 
-    // First remove children (iterate backwards so erasures don't invalidate earlier indices)
-    for (int i = (int)tasks.size() - 1; i >= 0; --i) {
-        if (tasks[i].parent == idx) {
-            removeTaskAndChildren(i);
+        ImGui::Separator();
+        ImGui::Text("Weekly Status (inline):");
+        ImGui::InputTextMultiline("Weekly status###weekly_status_inline_right", weeklyStatusText, sizeof(weeklyStatusText), ImVec2(-1,140));
+        ImGui::SameLine();
+        if (ImGui::Button("Save Weekly Status###btn_save_weekly_inline_right")) {
+            if (std::strlen(weeklyStatusText)>0) { save_weekly_status_to_disk_and_log(weeklyStatusText); std::memset(weeklyStatusText,0,sizeof(weeklyStatusText)); }
         }
-    }
+        ImGui::SameLine();
+        ImGui::BeginDisabled(instance_is_secondary());
+        if (ImGui::Button("Export Weekly Status (file)###btn_export_weekly_status_right")) {
+            std::string p = export_text_to_file("weekly_status_export", weeklyStatusText);
+            if (!p.empty()) append_daily_log("EXPORT", std::string("Exported weekly status to ") + p);
+        }
+        ImGui::EndDisabled();
 
-    // Log removal (optional)
-    append_daily_log("TASK_REMOVE", std::string("Removed task: ") + tasks[idx].name);
+        ImGui::Separator();
+        ImGui::BeginDisabled(instance_is_secondary());
+        if (ImGui::Button("Export Hourly Logs (today)###btn_export_hourly_today_right")) {
+            export_hourly_logs_today();
+        }
+        ImGui::EndDisabled();
 
-    // Erase the task
-    tasks.erase(tasks.begin() + idx);
+    ImGui::EndChild();
 
-    // After erasing an element, indices > idx shift down by 1.
-    // Update parent references so they still point to the correct tasks.
-    for (auto &t : tasks) {
-        if (t.parent > idx) --t.parent;
-        // If some code uses -2 or special parent markers, handle here — this assumes parent is index or -1.
+    ImGui::End(); // MainWindow
+
+    if (showStatsWindow) drawStatsWindow(&showStatsWindow);
+    if (showAnalysisWindow) drawAnalysisWindow(&showAnalysisWindow);
+    if (showProfilerWindow) drawProfilerWindow(&showProfilerWindow);
+
+    // Hourly popup
+    if (ImGui::BeginPopupModal("Hourly Log", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        if (ImGui::IsWindowAppearing()) ImGui::SetKeyboardFocusHere(0);
+        ImGui::Text("What did you do this hour?");
+        ImGui::InputText("##hourly_modal_input", hourlyInputText, sizeof(hourlyInputText));
+        ImGui::Separator();
+        if (ImGui::Button("Log###btn_modal_hourly_log")) {
+            if (std::strlen(hourlyInputText) > 0) append_daily_log("HOURLY", std::string(hourlyInputText));
+            std::memset(hourlyInputText, 0, sizeof(hourlyInputText));
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Skip###btn_modal_hourly_skip")) {
+            std::memset(hourlyInputText, 0, sizeof(hourlyInputText));
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::EndPopup();
     }
+}
 
-    // Persist
-    save_tasks();
+// ----------------------- Startup / shutdown -------------------------------
+// Shared by the windowed app and headless runs.
+static bool headlessRun = false;
+
+// Storage and endpoints only the instance that owns the data directory runs.
+static void app_start_primary_services() {
+    if (!storage) storage_open();
+    ipc_start();
+    live_reload_start();
+    api_start();
+    // Headless runs work on a scratch dir nobody watches
+    if (!headlessRun) status_page_open();
 }
 
-static void drawTasksRecursive(int idx, int depth = 0)
-{
-    // Safety
-    if (idx < 0 || idx >= (int)tasks.size()) return;
+static void app_startup() {
+    const char* countAllocs = getenv("PT_COUNT_ALLOCS");
+    if (countAllocs && *countAllocs == '1') allocCountingEnabled.store(true);
+    // Rebuild tasks, logs, breaks and the session timer from snapshot + journal; a
+    // secondary instance loads the primary's state instead
+    load_log_styles();
+    if (instance_start()) wal_recover();
+    search_index_init();
+    jobPool.start(std::min(4u, std::max(2u, std::thread::hardware_concurrency())));
+    trigram_index_start();
+    export_cache_load();
+    if (!instance_is_secondary()) export_store_maintain();
+    alert_init();
+    if (!instance_is_secondary()) app_start_primary_services();
+}
+static void app_shutdown() {
+    status_page_close();
+    api_stop();
+    live_reload_stop();
+    ipc_stop();
+    stop_analysis_blocking();
+    // Finish queued exports/snapshots/alerts, then apply their results before the final snapshot
+    jobPool.shutdown();
+    run_ui_completions();
+    if (headlessRun) {
+        // Seeded state is synthetic: no final snapshot, so none of it reaches state.snap
+        if (wal_file) { fclose(wal_file); wal_file = nullptr; }
+    } else if (!instance_is_secondary()) {
+        wal_shutdown();
+        search_index_save();
+    }
+    storage_close();
+    instance_release();
+}
 
-    ImGui::PushID(idx);
+// ----------------------- Headless frames ----------------------------------
+// --headless-frames N [--warmup W] [--alloc-budget B] [--max-p99-ms T]
+//                     [--seed-logs L] [--seed-tasks K] [--seed-breaks M]
+// Builds N frames of the real UI with no window or GL context: ImGui runs with a
+// null renderer (draw data is produced and counted, never submitted). Synthetic
+// mouse input walks a grid over the window and scrolls whatever is under it, so the
+// logs list, task tree and breaks table all get scrolled. The --seed-* options fill
+// the in-memory state with synthetic entries first (through wal_apply, so every
+// index is maintained as in a real session; nothing is journaled, and headless runs
+// skip the final snapshot and search.idx save).
+// Reports per-frame CPU time of NewFrame+UI and of Render as percentiles, plus UI-thread
+// allocations. Frames after the first W (default 30) are "steady state"; the run fails
+// with exit code 2 if one allocates more than B times, 3 if the steady-state p99 of
+// NewFrame+UI+Render exceeds T ms.
+// Runs against PT_DATA_DIR, or a fresh temporary data dir when that is unset (removed
+// again at the end), so the real ~/.productivity_tracker is never touched.
+struct HeadlessOptions {
+    int frames = 0;
+    int warmup = 30;
+    long allocBudget = -1;  // -1: report only
+    double maxP99Ms = -1.0; // -1: report only
+    int seedLogs = 0;
+    int seedTasks = 0;
+    int seedBreaks = 0;
+    int benchStorage = 0;   // --bench-storage N: storage backend benchmark instead of frames
+};
 
-    // Checkbox first (first-column behavior)
-    bool done = tasks[idx].done;
-    if (ImGui::Checkbox("##task_done", &done)) {
-        tasks[idx].done = done;
-        save_tasks();
-        append_daily_log("TASK", std::string("Toggled task: ") + tasks[idx].name + (done ? " [done]" : " [not done]"));
+static bool parse_headless_options(int argc, char** argv, HeadlessOptions &opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (a == "--headless-frames" && v) { opt.frames = std::max(1, atoi(v)); ++i; }
+        else if (a == "--warmup" && v) { opt.warmup = std::max(0, atoi(v)); ++i; }
+        else if (a == "--alloc-budget" && v) { opt.allocBudget = atol(v); ++i; }
+        else if (a == "--max-p99-ms" && v) { opt.maxP99Ms = atof(v); ++i; }
+        else if (a == "--seed-logs" && v) { opt.seedLogs = std::max(0, atoi(v)); ++i; }
+        else if (a == "--seed-tasks" && v) { opt.seedTasks = std::max(0, atoi(v)); ++i; }
+        else if (a == "--seed-breaks" && v) { opt.seedBreaks = std::max(0, atoi(v)); ++i; }
+        else if (a == "--bench-storage" && v) { opt.benchStorage = std::max(0, atoi(v)); ++i; }
     }
+    return opt.frames > 0 || opt.benchStorage > 0;
+}
 
-    // Simple delete "X" right after the checkbox
-    ImGui::SameLine();
-    {
-        ImGui::PushStyleColor(ImGuiCol_Button,        ImVec4(0.70f, 0.12f, 0.12f, 1.0f));
-        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.90f, 0.18f, 0.18f, 1.0f));
-        ImGui::PushStyleColor(ImGuiCol_ButtonActive,  ImVec4(0.80f, 0.14f, 0.14f, 1.0f));
+static std::string headlessScratchDir; // created by use_scratch_data_dir(), removed at exit
+
+static bool use_scratch_data_dir() {
+    const char* dir = getenv("PT_DATA_DIR");
+    if (dir && *dir) return true;
+#ifndef _WIN32
+    char tmpl[] = "/tmp/pt_headless_XXXXXX";
+    if (!mkdtemp(tmpl)) { perror("mkdtemp"); return false; }
+    setenv("PT_DATA_DIR", tmpl, 1);
+    headlessScratchDir = tmpl;
+    fprintf(stderr, "headless: using data dir %s\n", tmpl);
+    return true;
+#else
+    fprintf(stderr, "headless: set PT_DATA_DIR to a scratch directory\n");
+    return false;
+#endif
+}
 
-        std::string xId = std::string("X###del_") + std::to_string(idx);
-        if (ImGui::SmallButton(xId.c_str())) {
-            removeTaskAndChildren(idx);
-            ImGui::PopStyleColor(3); // pop the three pushed colors
-            ImGui::PopID();          // balance the earlier PushID(idx)
-            return;
-        }
+#ifndef _WIN32
+static void remove_dir_tree(const std::string &dir) {
+    for (const std::string &name : list_directory(dir)) {
+        std::string path = dir + "/" + name;
+        struct stat st;
+        if (lstat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) remove_dir_tree(path);
+        else unlink(path.c_str());
+    }
+    rmdir(dir.c_str());
+}
+#endif
+static void remove_scratch_data_dir() {
+#ifndef _WIN32
+    if (!headlessScratchDir.empty()) remove_dir_tree(headlessScratchDir);
+    headlessScratchDir.clear();
+#endif
+}
 
-        ImGui::PopStyleColor(3); // pop the three pushed colors for the non-click path
+// Synthetic history ending now: logs a minute apart, a task forest a few levels deep,
+// and closed breaks of every type.
+static void seed_synthetic_data(const HeadlessOptions &opt) {
+    static const char* kTypes[] = { "HOURLY", "HOURLY", "HOURLY", "TASK", "BREAK_START", "BREAK_END", "EXPORT", "DAILY_STATUS" };
+    static const char* kWords[] = { "review", "design", "PROJ-1234", "deploy", "meeting", "debugging", "host-17.corp", "notes" };
+    std::mt19937 gen(12345);
+    time_t now = time(nullptr);
+    for (int i = 0; i < opt.seedLogs; ++i) {
+        WalRecord r; r.op = WalOp::Log;
+        r.ts = (int64_t)(now - (time_t)(opt.seedLogs - i) * 60);
+        r.s1 = kTypes[gen() % 8];
+        r.s2 = std::string("synthetic ") + kWords[gen() % 8] + " " + kWords[gen() % 8] + " #" + std::to_string(i);
+        wal_apply(r);
     }
+    for (int i = 0; i < opt.seedTasks; ++i) {
+        WalRecord r; r.op = WalOp::TaskAdd;
+        r.s1 = std::string("Synthetic task ") + std::to_string(i) + " " + kWords[gen() % 8];
+        r.index = (i < 8 || gen() % 3 == 0) ? -1 : (int32_t)(gen() % i);
+        wal_apply(r);
+    }
+    for (int i = 0; i < opt.seedBreaks; ++i) {
+        WalRecord r; r.op = WalOp::BreakStart;
+        r.ts = (int64_t)(now - (time_t)(opt.seedBreaks - i) * 1800);
+        r.ts2 = r.ts + 300 + (int64_t)(gen() % 900);
+        r.s1 = kBreakTypes[gen() % kBreakTypes.size()];
+        wal_apply(r);
+    }
+}
 
-    // Place tree node to the right of the checkbox+X
-    ImGui::SameLine();
+// --bench-storage N: N synthetic logs (one a minute) into each storage backend, in a
+// fresh subdirectory of the scratch data dir. Reports single inserts (the first 2000,
+// each its own append/transaction as for a lone HOURLY entry), batched inserts (the
+// rest, 256 per batch as in an IPC burst) and random one-day range queries.
+static int run_storage_bench(int n) {
+    static const char* kTypes[] = { "HOURLY", "HOURLY", "HOURLY", "TASK", "BREAK_START", "BREAK_END", "EXPORT", "DAILY_STATUS" };
+    const char* kinds[] = { "files", "sqlite" };
+    const int singles = std::min(n, 2000), batchSize = 256, queries = 200;
+    const time_t start = time(nullptr) - (time_t)n * 60;
+    auto ms_since = [](std::chrono::steady_clock::time_point t0) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    };
+    printf("storage: %d logs, %d single inserts, batches of %d, %d one-day range queries\n", n, singles, batchSize, queries);
+    for (const char* kind : kinds) {
+        std::string dir = user_data_dir() + "/bench_" + kind;
+        ensure_dir_exists(dir);
+        std::unique_ptr<StorageBackend> st = storage_create(kind, dir);
+        if (strcmp(st->name(), kind) != 0) continue; // sqlite not built in
+        auto add = [&](int i) { st->append_log(start + (time_t)i * 60, kTypes[i % 8], "synthetic entry #" + std::to_string(i)); };
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < singles; ++i) add(i);
+        double singleMs = ms_since(t0);
+        t0 = std::chrono::steady_clock::now();
+        for (int i = singles; i < n; i += batchSize) {
+            st->begin_batch();
+            for (int j = i; j < std::min(n, i + batchSize); ++j) add(j);
+            st->end_batch();
+        }
+        double batchMs = ms_since(t0);
+        std::mt19937 gen(7);
+        std::vector<DailyLog> rows;
+        size_t found = 0;
+        t0 = std::chrono::steady_clock::now();
+        for (int q = 0; q < queries; ++q) {
+            time_t from = start + (time_t)(gen() % (uint32_t)std::max(1, n)) * 60;
+            rows.clear();
+            st->query_range(from, from + 86400, rows);
+            found += rows.size();
+        }
+        double queryMs = ms_since(t0);
+        printf("storage: %-6s single %9.0f/s  batched %9.0f/s  range queries %8.1f/s (%zu rows)\n", kind,
+               singles / std::max(singleMs, 1e-6) * 1000.0, (n - singles) / std::max(batchMs, 1e-6) * 1000.0,
+               queries / std::max(queryMs, 1e-6) * 1000.0, found);
+    }
+    return 0;
+}
 
-    // Indent the tree node according to depth so arrows/labels line up correctly.
-    const float indentPerLevel = 18.0f;
-    if (depth > 0) ImGui::Indent(depth * indentPerLevel);
+// Null renderer: walks the draw data as a renderer would, without submitting it.
+static size_t null_render(const ImDrawData* dd) {
+    size_t vtx = 0;
+    if (!dd) return 0;
+    for (int i = 0; i < dd->CmdListsCount; ++i) vtx += (size_t)dd->CmdLists[i]->VtxBuffer.Size;
+    return vtx;
+}
 
-    // Determine if this node has children
-    bool hasChild = false;
-    for (int i = 0; i < (int)tasks.size(); ++i) {
-        if (tasks[i].parent == idx) { hasChild = true; break; }
-    }
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    size_t k = (size_t)(p * (double)(v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
 
-    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
-    if (!hasChild) flags |= ImGuiTreeNodeFlags_Leaf;
+static int run_headless_frames(const HeadlessOptions &opt) {
+    headlessRun = true;
+    allocCountingEnabled.store(true);
 
-    // Draw the tree node label
-    bool opened = ImGui::TreeNodeEx((void*)(intptr_t)idx, flags, "%s", tasks[idx].name.c_str());
+    IMGUI_CHECKVERSION();
+    ImGui::SetAllocatorFunctions(imgui_counted_alloc, imgui_counted_free, nullptr);
+    ImGui::CreateContext();
+    ImGuiIO &io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.BackendRendererName = "null";
+    io.DisplaySize = ImVec2(1200.0f, 760.0f);
+    ApplyGrayTheme();
+    io.Fonts->AddFontDefault();
+    unsigned char* pixels = nullptr;
+    int tw = 0, th = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &tw, &th); // builds the atlas; nothing uploads it
+
+    app_startup();
+    auto seedStart = std::chrono::steady_clock::now();
+    seed_synthetic_data(opt);
+    if (opt.seedLogs || opt.seedTasks || opt.seedBreaks)
+        printf("headless: seeded %d logs, %d tasks, %d breaks in %.0f ms\n", opt.seedLogs, opt.seedTasks, opt.seedBreaks,
+               std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - seedStart).count());
+
+    // Grid of points the synthetic mouse visits, 40 frames each, scrolling down then up
+    const int kCols = 4, kRows = 3, kFramesPerPoint = 40;
+    std::vector<uint64_t> allocs;
+    std::vector<double> buildMs, renderMs, totalMs;
+    size_t maxVtx = 0;
+    for (int f = 0; f < opt.frames && !request_quit.load(); ++f) {
+        int point = (f / kFramesPerPoint) % (kCols * kRows);
+        float mx = io.DisplaySize.x * ((point % kCols) + 0.5f) / kCols;
+        float my = io.DisplaySize.y * ((point / kCols) + 0.5f) / kRows;
+        io.AddMousePosEvent(mx, my);
+        io.AddMouseWheelEvent(0.0f, (f % kFramesPerPoint) < kFramesPerPoint / 2 ? -1.0f : 1.0f);
+        io.DeltaTime = 1.0f / 60.0f;
+
+        frame_profile_begin();
+        auto t0 = std::chrono::steady_clock::now();
+        ImGui::NewFrame();
+        drawFrameUI();
+        auto t1 = std::chrono::steady_clock::now();
+        ImGui::Render();
+        maxVtx = std::max(maxVtx, null_render(ImGui::GetDrawData()));
+        auto t2 = std::chrono::steady_clock::now();
+        frame_profile_end();
+        run_ui_completions(); // let background results (trigram index, exports) land as they would between frames
+
+        allocs.push_back(frameProfile.lastAllocs);
+        buildMs.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        renderMs.push_back(std::chrono::duration<double, std::milli>(t2 - t1).count());
+        totalMs.push_back(buildMs.back() + renderMs.back());
+    }
 
-    // Unindent immediately after drawing the node so children are indented relative to the node.
-    if (depth > 0) ImGui::Unindent(depth * indentPerLevel);
+    app_shutdown();
+    ImGui::DestroyContext();
 
-    // If expanded, recurse into children
-    if (opened) {
-        for (int i = 0; i < (int)tasks.size(); ++i) {
-            if (tasks[i].parent == idx) {
-                drawTasksRecursive(i, depth + 1);
-            }
-        }
-        ImGui::TreePop();
+    size_t first = std::min(allocs.size(), (size_t)opt.warmup);
+    uint64_t maxAllocs = 0, sumAllocs = 0;
+    int worst = -1;
+    for (size_t i = first; i < allocs.size(); ++i) {
+        sumAllocs += allocs[i];
+        if (worst < 0 || allocs[i] > maxAllocs) { maxAllocs = allocs[i]; worst = (int)i; }
+    }
+    size_t steady = allocs.size() - first;
+    auto steadyOf = [first](const std::vector<double> &v) { return std::vector<double>(v.begin() + first, v.end()); };
+    auto report = [&](const char* what, const std::vector<double> &v) {
+        std::vector<double> st = steadyOf(v);
+        printf("headless: %-14s p50 %.3f  p90 %.3f  p99 %.3f  max %.3f ms\n", what,
+               percentile(st, 0.50), percentile(st, 0.90), percentile(st, 0.99), percentile(st, 1.0));
+    };
+    printf("headless: %zu frames (%zu steady), %zu logs, %zu tasks, %zu breaks, up to %zu vertices/frame\n",
+           allocs.size(), steady, dailyLogs.size(), tasks.size(), breaks.size(), maxVtx);
+    report("NewFrame+UI", buildMs);
+    report("Render", renderMs);
+    report("total", totalMs);
+    printf("headless: steady-state allocations/frame: %.1f avg, %llu max (frame %d)\n",
+           steady ? (double)sumAllocs / steady : 0.0, (unsigned long long)maxAllocs, worst);
+    if (opt.allocBudget >= 0 && (long)maxAllocs > opt.allocBudget) {
+        printf("headless: FAIL - allocation budget %ld per frame exceeded\n", opt.allocBudget);
+        return 2;
+    }
+    if (opt.allocBudget >= 0) printf("headless: OK - within allocation budget %ld per frame\n", opt.allocBudget);
+    double p99 = percentile(steadyOf(totalMs), 0.99);
+    if (opt.maxP99Ms >= 0.0 && p99 > opt.maxP99Ms) {
+        printf("headless: FAIL - p99 frame time %.3f ms exceeds %.3f ms\n", p99, opt.maxP99Ms);
+        return 3;
     }
+    if (opt.maxP99Ms >= 0.0) printf("headless: OK - p99 frame time within %.3f ms\n", opt.maxP99Ms);
+    return 0;
+}
 
-    ImGui::PopID();
+static int run_headless(const HeadlessOptions &opt) {
+    if (!use_scratch_data_dir()) return 1;
+    int rc = opt.benchStorage > 0 ? run_storage_bench(opt.benchStorage) : run_headless_frames(opt);
+    remove_scratch_data_dir();
+    return rc;
 }
 
 // ----------------------- Main ---------------------------------------------
-int main(int, char**) {
+int main(int argc, char** argv) {
+    HeadlessOptions headless;
+    if (parse_headless_options(argc, argv, headless)) return run_headless(headless);
+
     if (!glfwInit()) { fprintf(stderr,"glfwInit failed\n"); return 1; }
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -765,6 +6303,7 @@ int main(int, char**) {
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) { fprintf(stderr,"gladLoadGLLoader failed\n"); glfwDestroyWindow(window); glfwTerminate(); return 1; }
 
     IMGUI_CHECKVERSION();
+    ImGui::SetAllocatorFunctions(imgui_counted_alloc, imgui_counted_free, nullptr);
     ImGui::CreateContext();
     ImGuiIO &io = ImGui::GetIO(); (void)io;
 
@@ -787,13 +6326,7 @@ int main(int, char**) {
     io.Fonts->AddFontDefault();
     ImGui_ImplOpenGL3_CreateDeviceObjects();
 
-    load_tasks();
-    load_daily_logs();
-
-    // record session start
-    app_start_time = time(nullptr);
-    tracking_start_time = app_start_time;
-    accumulated_tracked_seconds = 0;
+    app_startup();
 
     double lastTime = glfwGetTime();
     int lastHour = -1;
@@ -826,441 +6359,17 @@ int main(int, char**) {
 
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
+        frame_profile_begin();
         ImGui::NewFrame();
 
-        // Open hourly popup if requested and play alert
-        if (requestHourlyPopup) {
-            ImGui::OpenPopup("Hourly Log");
-            play_alert_async();
-            requestHourlyPopup = false;
-        }
-
-        // Main window spanning the work area
-        ImGuiViewport* vp = ImGui::GetMainViewport();
-        ImGui::SetNextWindowPos(vp->WorkPos);
-        ImGui::SetNextWindowSize(vp->WorkSize);
-        ImGuiWindowFlags mainFlags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize
-                                   | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_MenuBar;
-        ImGui::Begin("MainWindow", nullptr, mainFlags);
-
-        // Menu bar
-        if (ImGui::BeginMenuBar()) {
-            if (ImGui::BeginMenu("File")) {
-                if (ImGui::MenuItem("Save Tasks")) save_tasks();
-                if (ImGui::MenuItem("Save Daily Logs")) {
-                    for (const auto &d : dailyLogs) append_line_to_file(path_in_data("daily_logs.txt"), human_log_line(d.type.c_str(), d.text, d.ts));
-                }
-                if (ImGui::MenuItem("Quit")) glfwSetWindowShouldClose(window, GLFW_TRUE);
-                ImGui::EndMenu();
-            }
-            ImGui::EndMenuBar();
-        }
-        
-        // Toolbar (Test, Random, Exports, Clear All)
-        
-
-        // Top toolbar: Test hourly, Random break, Export statuses, Export weekly logs, Export hourly (today)
-        // Test Hourly Popup (neutral)
-        {
-            ImVec4 btn = ImVec4(0.20f,0.20f,0.22f,1.0f);
-            ImVec4 btnH = ImVec4(0.26f,0.26f,0.28f,1.0f);
-            ImVec4 btnA = ImVec4(0.22f,0.22f,0.24f,1.0f);
-            ImGui::PushStyleColor(ImGuiCol_Button, btn);
-            ImGui::PushStyleColor(ImGuiCol_ButtonHovered, btnH);
-            ImGui::PushStyleColor(ImGuiCol_ButtonActive, btnA);
-            if (ImGui::Button(makeButtonLabel("Test Hourly Popup", "btn_test_hourly_popup").c_str())) requestHourlyPopup = true;
-            ImGui::PopStyleColor(3);
-        }
-        ImGui::SameLine();
-
-        // End Day (orange)
-        {
-            ImVec4 b = ImVec4(0.9f,0.45f,0.12f,1.0f);
-            ImVec4 bh = ImVec4(0.95f,0.60f,0.20f,1.0f);
-            ImVec4 ba = ImVec4(0.85f,0.40f,0.10f,1.0f);
-            ImGui::PushStyleColor(ImGuiCol_Button, b);
-            ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
-            ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
-            if (ImGui::Button(makeButtonLabel("End Day", "btn_end_day").c_str())) ImGui::OpenPopup("Confirm End Day");
-            ImGui::PopStyleColor(3);
-
-            if (ImGui::BeginPopupModal("Confirm End Day", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
-                if (ImGui::IsWindowAppearing()) ImGui::SetKeyboardFocusHere();
-                ImGui::TextWrapped("This will end any active breaks, pause the session timer, export logs/status and reset tracking for the next day. Proceed?");
-                ImGui::Separator();
-                if (ImGui::Button("Yes - End Day")) {
-                    end_day_action();
-                    ImGui::CloseCurrentPopup();
-                }
-                ImGui::SameLine();
-                if (ImGui::Button("Cancel")) {
-                    ImGui::CloseCurrentPopup();
-                }
-                ImGui::EndPopup();
-            }
-        }
-        ImGui::SameLine();
-
-        // Random Break (red)
-        {
-            ImVec4 b = ImVec4(0.45f,0.20f,0.20f,1.0f);
-            ImVec4 bh = ImVec4(0.70f,0.22f,0.22f,1.0f);
-            ImVec4 ba = ImVec4(0.60f,0.18f,0.18f,1.0f);
-            ImGui::PushStyleColor(ImGuiCol_Button, b);
-            ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
-            ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
-            if (ImGui::Button(makeButtonLabel("Random Break", "btn_random_break").c_str())) add_random_break();
-            ImGui::PopStyleColor(3);
-        }
-        ImGui::SameLine();
-
-        // Export Daily Status (yellow)
-        {
-            ImVec4 b = ImVec4(0.60f,0.55f,0.20f,1.0f);
-            ImVec4 bh = ImVec4(0.85f,0.78f,0.22f,1.0f);
-            ImVec4 ba = ImVec4(0.70f,0.65f,0.18f,1.0f);
-            ImGui::PushStyleColor(ImGuiCol_Button, b);
-            ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
-            ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
-            if (ImGui::Button(makeButtonLabel("Export Daily Status (file)", "btn_export_daily_status_top").c_str())) {
-                std::string path = export_text_to_file("daily_status_export", dailyStatusText);
-                if (!path.empty()) append_daily_log("EXPORT", std::string("Exported daily status to ") + path);
-            }
-            ImGui::PopStyleColor(3);
-        }
-        ImGui::SameLine();
-
-        // Export Weekly Status (green)
-        {
-            ImVec4 b = ImVec4(0.20f,0.55f,0.30f,1.0f);
-            ImVec4 bh = ImVec4(0.22f,0.78f,0.40f,1.0f);
-            ImVec4 ba = ImVec4(0.18f,0.68f,0.28f,1.0f);
-            ImGui::PushStyleColor(ImGuiCol_Button, b);
-            ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
-            ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
-            if (ImGui::Button(makeButtonLabel("Export Weekly Status (file)", "btn_export_weekly_status_top").c_str())) {
-                std::string path = export_text_to_file("weekly_status_export", weeklyStatusText);
-                if (!path.empty()) append_daily_log("EXPORT", std::string("Exported weekly status to ") + path);
-            }
-            ImGui::PopStyleColor(3);
-        }
-        ImGui::SameLine();
-
-        // Export Weekly Logs (purple) - includes daily status & hourly logs (LLM-friendly section)
-        {
-            ImVec4 b = ImVec4(0.45f,0.30f,0.6f,1.0f);
-            ImVec4 bh = ImVec4(0.65f,0.38f,0.85f,1.0f);
-            ImVec4 ba = ImVec4(0.55f,0.34f,0.72f,1.0f);
-            ImGui::PushStyleColor(ImGuiCol_Button, b);
-            ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
-            ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
-            if (ImGui::Button(makeButtonLabel("Export Weekly Logs (file)", "btn_export_weekly_logs_top").c_str())) {
-                std::string p = export_weekly_logs_file();
-                if (!p.empty()) append_daily_log("EXPORT", std::string("Exported weekly logs to ") + p);
-            }
-            ImGui::PopStyleColor(3);
-        }
-        ImGui::SameLine();
-        // Analyze Productivity (AI)
-        {
-            ImVec4 b = ImVec4(0.12f,0.55f,0.40f,1.0f);
-            ImVec4 bh = ImVec4(0.18f,0.75f,0.55f,1.0f);
-            ImVec4 ba = ImVec4(0.10f,0.45f,0.32f,1.0f);
-            ImGui::PushStyleColor(ImGuiCol_Button, b);
-            ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh);
-            ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba);
-            if (ImGui::Button(makeButtonLabel("Analyze Productivity (AI)", "btn_analyze_ai").c_str())) {
-                launch_analysis_script();
-            }
-            ImGui::PopStyleColor(3);
-        }
-        ImGui::SameLine();
-
-        {
-            ImVec4 b  = ImVec4(0.7f, 0.12f, 0.12f, 1.0f);
-            ImVec4 bh = ImVec4(0.9f, 0.18f, 0.18f, 1.0f);
-            ImVec4 ba = ImVec4(0.8f, 0.14f, 0.14f, 1.0f);
-
-            ImGui::PushStyleColor(ImGuiCol_Button,         b);
-            ImGui::PushStyleColor(ImGuiCol_ButtonHovered,  bh);
-            ImGui::PushStyleColor(ImGuiCol_ButtonActive,   ba);
-
-            if (ImGui::Button("Clear All###btn_clear_all"))
-                ImGui::OpenPopup("Confirm Clear All");
-
-            // Always pop the three colors we pushed above (do this regardless of whether the button was pressed)
-            ImGui::PopStyleColor(3);
-
-            // Confirmation modal (opened by ImGui::OpenPopup above)
-            if (ImGui::BeginPopupModal("Confirm Clear All", NULL, ImGuiWindowFlags_AlwaysAutoResize))
-            {
-                // When the window appears, set default focus on the "Yes" button for quicker keyboard confirmation
-                if (ImGui::IsWindowAppearing())
-                    ImGui::SetKeyboardFocusHere();
-
-                ImGui::TextWrapped(
-                    "This will delete all persisted logs, tasks and status files and CLEAR in-memory data.\n\n"
-                    "This action cannot be undone. Do you want to proceed?"
-                );
-                ImGui::Separator();
-
-                // Confirm
-                if (ImGui::Button("Yes - Clear All"))
-                {
-                    // clear in-memory + persisted state
-                    clearAllData();
-
-                    ImGui::CloseCurrentPopup();
-                }
-
-                ImGui::SameLine();
-
-                // Cancel
-                if (ImGui::Button("Cancel"))
-                    ImGui::CloseCurrentPopup();
-
-                ImGui::EndPopup();
-            }
-        }
-        ImGui::Separator();
-
-        // Layout: left child (logs + tasks side-by-side) + right child (controls)
-        float availW = ImGui::GetContentRegionAvail().x;
-        float leftWidth = availW * 0.62f;
-        float rightWidth = availW - leftWidth - ImGui::GetStyle().ItemSpacing.x;
-
-        ImGui::BeginChild("left_panel", ImVec2(leftWidth, 0), true);
-            float half = (leftWidth - ImGui::GetStyle().ItemSpacing.x) * 0.5f;
-            ImGui::BeginChild("logs_col", ImVec2(half, 320), true, ImGuiWindowFlags_None);
-                ImGui::Text("Daily Logs:");
-                ImGui::Separator();
-                ImGui::BeginChild("logs_list", ImVec2(0, -1), false, ImGuiWindowFlags_HorizontalScrollbar);
-                    if (!dailyLogs.empty()) {
-                        for (int i = (int)dailyLogs.size()-1; i>=0; --i) {
-                            const DailyLog &d = dailyLogs[i];
-                            ImVec4 col;
-                            if (d.type == "HOURLY") col = ImVec4(0.4f,0.7f,1.0f,1.0f);
-                            else if (d.type == "DAILY_STATUS") col = ImVec4(1.0f,0.9f,0.4f,1.0f);
-                            else if (d.type == "WEEKLY_STATUS") col = ImVec4(0.6f,1.0f,0.6f,1.0f);
-                            else if (d.type.rfind("BREAK",0)==0) col = ImVec4(1.0f,0.6f,0.6f,1.0f);
-                            else if (d.type == "EXPORT") col = ImVec4(0.8f,0.6f,1.0f,1.0f);
-                            else if (d.type == "TASK") col = ImVec4(0.8f,0.8f,0.85f,1.0f);
-                            else col = ImVec4(0.9f,0.9f,0.9f,1.0f);
-                            ImGui::PushStyleColor(ImGuiCol_Text, col);
-                            ImGui::TextWrapped("%s", human_log_line(d.type.c_str(), d.text, d.ts).c_str());
-                            ImGui::PopStyleColor();
-                        }
-                    } else {
-                        ImGui::TextDisabled("(no logs yet)");
-                    }
-                ImGui::EndChild();
-            ImGui::EndChild();
-
-            ImGui::SameLine();
-
-            ImGui::BeginChild("tasks_col", ImVec2(half, 320), true, ImGuiWindowFlags_None);
-            ImGui::Text("Tasks:");
-            ImGui::Separator();
-            ImGui::BeginChild("tasks_list", ImVec2(0, -1), false, ImGuiWindowFlags_None);
-            if (!tasks.empty()) {
-                for (int i = 0; i < (int)tasks.size(); ++i)
-                    if (tasks[i].parent == -1)
-                        drawTasksRecursive(i);
-            } else {
-                ImGui::TextDisabled("(no tasks)");
-            }
-            ImGui::EndChild();
-            ImGui::EndChild();
-
-            ImGui::Separator();
-
-            ImGui::Text("Breaks:");
-            if (!breaks.empty()) {
-                if (ImGui::BeginTable("tbl_breaks_left", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
-                    ImGui::TableSetupColumn("Type", ImGuiTableColumnFlags_WidthFixed, 120.0f);
-                    ImGui::TableSetupColumn("Start/End", ImGuiTableColumnFlags_WidthStretch);
-                    ImGui::TableSetupColumn("Action", ImGuiTableColumnFlags_WidthFixed, 120.0f);
-                    ImGui::TableHeadersRow();
-                    for (int i=(int)breaks.size()-1;i>=0;--i) {
-                        ImGui::TableNextRow();
-                        ImGui::TableNextColumn(); ImGui::TextUnformatted(breaks[i].type.c_str());
-                        ImGui::TableNextColumn();
-                        if (breaks[i].start) {
-                            if (breaks[i].end) ImGui::Text("%s -> %s", format_time_local(breaks[i].start).c_str(), format_time_local(breaks[i].end).c_str());
-                            else ImGui::Text("%s (active)", format_time_local(breaks[i].start).c_str());
-                        } else ImGui::TextUnformatted("(n/a)");
-                        ImGui::TableNextColumn();
-                        if (breaks[i].end == 0) {
-                            char endLabel[64]; snprintf(endLabel, sizeof(endLabel), "End %d###btn_end_%d", i, i);
-                            if (ImGui::Button(endLabel)) { breaks[i].end = time(nullptr); append_daily_log("BREAK_END", std::string("Ended break: ") + breaks[i].type); }
-                        } else {
-                            char startLabel[64]; snprintf(startLabel, sizeof(startLabel), "Start %d###btn_start_%d", i, i);
-                            if (ImGui::Button(startLabel)) start_break(breaks[i].type);
-                        }
-                    }
-                    ImGui::EndTable();
-                }
-            } else ImGui::TextDisabled("(no breaks yet)");
-        ImGui::EndChild();
-
-        ImGui::SameLine();
-
-        ImGui::BeginChild("right_panel", ImVec2(rightWidth, 0), true);
-            // Big session timer displayed prominently at the top of the right panel
-            {
-                time_t nowt = time(nullptr);
-                // Compute total tracked seconds (exclude time spent during active breaks)
-                long total_tracked = accumulated_tracked_seconds + ((tracking_start_time==0) ? 0L : (long)(nowt - tracking_start_time));
-                std::string dur = format_duration_seconds(total_tracked);
-                bool running = (tracking_start_time != 0);
-                std::string visible = std::string("Session: ") + dur + (running ? std::string("") : std::string(" (BREAK)"));
-                std::string btnLabel = makeButtonLabel(visible, "session_timer_btn");
-
-                // Running: dark green background, Paused: red background
-                ImVec4 b_run  = ImVec4(0.04f, 0.40f, 0.12f, 1.0f); // dark green
-                ImVec4 bh_run = ImVec4(0.08f, 0.55f, 0.20f, 1.0f);
-                ImVec4 ba_run = ImVec4(0.03f, 0.33f, 0.10f, 1.0f);
-
-                ImVec4 b_paused  = ImVec4(0.85f, 0.12f, 0.12f, 1.0f); // red when paused
-                ImVec4 bh_paused = ImVec4(0.95f, 0.25f, 0.25f, 1.0f);
-                ImVec4 ba_paused = ImVec4(0.75f, 0.10f, 0.10f, 1.0f);
-
-                if (running) {
-                    ImGui::PushStyleColor(ImGuiCol_Button, b_run);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh_run);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba_run);
-                } else {
-                    ImGui::PushStyleColor(ImGuiCol_Button, b_paused);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, bh_paused);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive, ba_paused);
-                }
-
-                // Use black text for the timer label
-                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.02f, 0.02f, 0.02f, 1.0f));
-
-                // Temporarily increase font scale to make the text very large (timebomb look)
-                ImGuiIO &gio = ImGui::GetIO();
-                float oldScale = gio.FontGlobalScale;
-                gio.FontGlobalScale = oldScale * 2.0f;
-
-                // Use full available width and a taller height to make it visually prominent
-                float availW = ImGui::GetContentRegionAvail().x;
-                ImGui::Button(btnLabel.c_str(), ImVec2(availW, 100.0f));
-
-                // Restore font scale and pop the text color and button colors
-                gio.FontGlobalScale = oldScale;
-                ImGui::PopStyleColor(1); // pop text color
-                ImGui::PopStyleColor(3); // pop button colors
-                ImGui::Spacing();
-            }
-
-            ImGui::Text("Break Controls:");
-            ImGui::Separator();
-            ImGui::SetNextItemWidth(180);
-            if (ImGui::BeginCombo("Break Type###combo_break_types", kBreakTypes[selectedBreakTypeIndex].c_str())) {
-                for (int i = 0; i < (int)kBreakTypes.size(); ++i) {
-                    bool sel = (i == selectedBreakTypeIndex);
-                    if (ImGui::Selectable(kBreakTypes[i].c_str(), sel)) selectedBreakTypeIndex = i;
-                    if (sel) ImGui::SetItemDefaultFocus();
-                }
-                ImGui::EndCombo();
-            }
-            ImGui::SameLine();
-            if (ImGui::Button("Start Selected###btn_start_selected_right")) start_break(kBreakTypes[selectedBreakTypeIndex]);
-            ImGui::SameLine();
-            if (ImGui::Button("End Selected###btn_end_selected_right")) end_last_break_of_type(kBreakTypes[selectedBreakTypeIndex]);
-
-            ImGui::Separator();
-            ImGui::Text("Add Task:");
-            ImGui::InputText("Task name###input_task_name_right", newTaskText, sizeof(newTaskText));
-            std::vector<std::string> parentOptions;
-            parentOptions.push_back("(none)");
-            for (size_t i=0;i<tasks.size();++i) { std::ostringstream os; os<<i<<": "<<tasks[i].name; parentOptions.push_back(os.str()); }
-            static int parentComboIndex = 0;
-            ImGui::SetNextItemWidth(240);
-            if (ImGui::BeginCombo("Parent###combo_parent_right", parentOptions[parentComboIndex].c_str())) {
-                for (int n=0;n<(int)parentOptions.size();++n) {
-                    bool sel = (n==parentComboIndex);
-                    if (ImGui::Selectable(parentOptions[n].c_str(), sel)) { parentComboIndex = n; new_task_parent_idx = n - 1; }
-                    if (sel) ImGui::SetItemDefaultFocus();
-                }
-                ImGui::EndCombo();
-            }
-            ImGui::SameLine();
-            if (ImGui::Button("Add Task###btn_add_task_right")) {
-                if (std::strlen(newTaskText)>0) { add_task(std::string(newTaskText), new_task_parent_idx); std::memset(newTaskText,0,sizeof(newTaskText)); new_task_parent_idx=-1; }
-            }
-
-            ImGui::Separator();
-            ImGui::Text("Quick Daily Log:");
-            ImGui::InputText("Quick log###input_quick_log_right", hourlyInputText, sizeof(hourlyInputText));
-            ImGui::SameLine();
-            if (ImGui::Button("Log Now###btn_log_now_right")) {
-                if (std::strlen(hourlyInputText)>0) { append_daily_log("HOURLY", std::string(hourlyInputText)); std::memset(hourlyInputText, 0, sizeof(hourlyInputText)); }
-            }
-
-            ImGui::Separator();
-            ImGui::Text("Daily Status (inline):");
-            ImGui::InputTextMultiline("Daily status###daily_status_inline_right", dailyStatusText, sizeof(dailyStatusText), ImVec2(-1,100));
-            ImGui::SameLine();
-            if (ImGui::Button("Save Daily Status###btn_save_daily_inline_right")) {
-                if (std::strlen(dailyStatusText)>0) { save_daily_status_to_disk_and_log(dailyStatusText); std::memset(dailyStatusText,0,sizeof(dailyStatusText)); }
-            }
-            ImGui::SameLine();
-            if (ImGui::Button("Export Daily Status (file)###btn_export_daily_status_right")) {
-                std::string p = export_text_to_file("daily_status_export", dailyStatusText);
-                if (!p.empty()) append_daily_log("EXPORT", std::string("Exported daily status to ") + p);
-            }
-
-            ImGui::Separator();
-            ImGui::Text("Weekly Status (inline):");
-            ImGui::InputTextMultiline("Weekly status###weekly_status_inline_right", weeklyStatusText, sizeof(weeklyStatusText), ImVec2(-1,140));
-            ImGui::SameLine();
-            if (ImGui::Button("Save Weekly Status###btn_save_weekly_inline_right")) {
-                if (std::strlen(weeklyStatusText)>0) { save_weekly_status_to_disk_and_log(weeklyStatusText); std::memset(weeklyStatusText,0,sizeof(weeklyStatusText)); }
-            }
-            ImGui::SameLine();
-            if (ImGui::Button("Export Weekly Status (file)###btn_export_weekly_status_right")) {
-                std::string p = export_text_to_file("weekly_status_export", weeklyStatusText);
-                if (!p.empty()) append_daily_log("EXPORT", std::string("Exported weekly status to ") + p);
-            }
-
-            ImGui::Separator();
-            if (ImGui::Button(makeButtonLabel("Export Hourly Logs (today)", "btn_export_hourly_today_right").c_str())) {
-                std::string p = export_hourly_logs_today();
-                if (!p.empty()) append_daily_log("EXPORT", std::string("Exported hourly logs (today) to ") + p);
-            }
-
-        ImGui::EndChild();
+        drawFrameUI();
 
-        ImGui::End(); // MainWindow
-
-        // If end_day_action requested quitting, close the window to exit gracefully
-        if (request_quit.load()) {
-            glfwSetWindowShouldClose(window, GLFW_TRUE);
-        }
-
-        // Hourly popup
-        if (ImGui::BeginPopupModal("Hourly Log", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
-            if (ImGui::IsWindowAppearing()) ImGui::SetKeyboardFocusHere(0);
-            ImGui::Text("What did you do this hour?");
-            ImGui::InputText("##hourly_modal_input", hourlyInputText, sizeof(hourlyInputText));
-            ImGui::Separator();
-            if (ImGui::Button("Log###btn_modal_hourly_log")) {
-                if (std::strlen(hourlyInputText) > 0) append_daily_log("HOURLY", std::string(hourlyInputText));
-                std::memset(hourlyInputText, 0, sizeof(hourlyInputText));
-                ImGui::CloseCurrentPopup();
-            }
-            ImGui::SameLine();
-            if (ImGui::Button("Skip###btn_modal_hourly_skip")) {
-                std::memset(hourlyInputText, 0, sizeof(hourlyInputText));
-                ImGui::CloseCurrentPopup();
-            }
-            ImGui::EndPopup();
-        }
+        // Quit menu item or end_day_action: close the window to exit gracefully
+        if (request_quit.load()) glfwSetWindowShouldClose(window, GLFW_TRUE);
 
         // Render
         ImGui::Render();
+        frame_profile_end();
         glViewport(0, 0, display_w, display_h);
         glClearColor(0.06f, 0.06f, 0.07f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
@@ -1269,6 +6378,8 @@ int main(int, char**) {
         glfwSwapBuffers(window);
     }
 
+    app_shutdown();
+
     // Cleanup
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -0,0 +1,476 @@
+// pt_aggregate.cpp
+// Team weekly rollup over many users' data directories (copies of ~/.productivity_tracker
+// collected on one machine). Writes, into --out:
+//   team_weekly_<start>.txt        team totals followed by one section per user
+//   team_weekly_<start>_logs.txt   every user's log entries of the week, merged by time,
+//                                  as "YYYY-MM-DD HH:MM:SS - user - TYPE - text"
+//
+// Usage: pt_aggregate [--week YYYY-MM-DD] [--threads N] [--out DIR] DIR...
+//   DIR is a user's data directory (contains daily_logs.txt), a directory holding a
+//   .productivity_tracker, or a directory whose subdirectories are either of those.
+//   The user name is the subdirectory name. --week is the first day of the 7-day
+//   window (default: the last 7 days including today).
+// Benchmark: pt_aggregate --seed-users N --seed-logs M [--threads N]
+//   generates N synthetic users with M log lines each under /tmp and aggregates them.
+//
+// Each directory is one job for a small thread pool. A job streams daily_logs.txt with
+// the app's own parsers (data_files.h), keeps only the week's lines (and BREAK_* lines,
+// for break durations), sorts them and spills them to a run file, so memory is bounded
+// by one user-week per thread. The runs are then k-way merged into the team log,
+// at most kMaxFanIn files at a time. Throughput is printed to stderr.
+
+#include "data_files.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const size_t kMaxFanIn = 64;
+
+struct UserDir { std::string user; std::string path; };
+
+struct Week {
+    time_t start = 0, end = 0;
+    std::string days[8]; // "YYYY-MM-DD" for each day and the day after the week
+};
+
+struct UserRollup {
+    std::string user;
+    std::string error;
+    uint64_t bytes = 0, lines = 0, weekLogs = 0, hourly = 0;
+    int hourlyPerDay[7] = {};
+    uint8_t activeDays = 0; // bit per day with at least one entry
+    std::map<std::string, uint64_t> byType;
+    std::map<std::string, int64_t> breakSeconds;
+    int tasksTotal = 0, tasksDone = 0;
+    std::string run; // sorted week entries: "<ts>\t<merged line>"
+};
+
+static bool is_dir(const std::string &p) { struct stat st; return stat(p.c_str(), &st) == 0 && S_ISDIR(st.st_mode); }
+static bool is_file(const std::string &p) { struct stat st; return stat(p.c_str(), &st) == 0 && S_ISREG(st.st_mode); }
+static std::string base_name(std::string p) {
+    while (p.size() > 1 && p.back() == '/') p.pop_back();
+    size_t s = p.rfind('/');
+    return s == std::string::npos ? p : p.substr(s + 1);
+}
+static std::string fmt_local(time_t t, const char* fmt) {
+    struct tm tm{};
+    localtime_r(&t, &tm);
+    char buf[64];
+    strftime(buf, sizeof(buf), fmt, &tm);
+    return buf;
+}
+static std::string fmt_duration(int64_t s) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%lldh %02lldm", (long long)(s / 3600), (long long)(s / 60 % 60));
+    return buf;
+}
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Local midnight of y-m-d plus `days`.
+static time_t local_midnight(int y, int m, int d, int days) {
+    struct tm tm{};
+    tm.tm_year = y - 1900; tm.tm_mon = m - 1; tm.tm_mday = d + days; tm.tm_isdst = -1;
+    return mktime(&tm);
+}
+static Week make_week(int y, int m, int d) {
+    Week w;
+    for (int i = 0; i < 8; ++i) w.days[i] = fmt_local(local_midnight(y, m, d, i), "%Y-%m-%d");
+    w.start = local_midnight(y, m, d, 0);
+    w.end = local_midnight(y, m, d, 7);
+    return w;
+}
+
+// ----------------------- Discovery ------------------------------------------
+static bool add_if_data_dir(const std::string &path, const std::string &user, std::vector<UserDir> &out) {
+    if (is_file(path + "/daily_logs.txt")) { out.push_back({user, path}); return true; }
+    if (is_file(path + "/.productivity_tracker/daily_logs.txt")) { out.push_back({user, path + "/.productivity_tracker"}); return true; }
+    return false;
+}
+static void discover(const std::string &arg, std::vector<UserDir> &out) {
+    std::string name = base_name(arg);
+    if (name == ".productivity_tracker") name = base_name(arg.substr(0, arg.rfind(".productivity_tracker")));
+    if (add_if_data_dir(arg, name, out)) return;
+    DIR* d = opendir(arg.c_str());
+    if (!d) { perror(arg.c_str()); return; }
+    std::vector<std::string> subs;
+    while (struct dirent* e = readdir(d)) {
+        if (e->d_name[0] == '.') continue;
+        std::string p = arg + "/" + e->d_name;
+        if (is_dir(p)) subs.push_back(e->d_name);
+    }
+    closedir(d);
+    std::sort(subs.begin(), subs.end());
+    for (const auto &s : subs) add_if_data_dir(arg + "/" + s, s, out);
+}
+
+// ----------------------- Per-user job ---------------------------------------
+static int day_of_week_index(const Week &w, const char* date) {
+    for (int i = 0; i < 7; ++i) if (w.days[i].compare(0, 10, date, 10) == 0) return i;
+    return -1;
+}
+static void add_break(UserRollup &r, const Week &w, const std::string &type, time_t start, time_t end) {
+    time_t s = std::max(start, w.start), e = std::min(end, w.end);
+    if (e > s) r.breakSeconds[type] += (int64_t)(e - s);
+}
+
+// Streams a file in 1 MiB blocks and hands out lines without copying them.
+struct LineReader {
+    FILE* f = nullptr;
+    std::vector<char> buf = std::vector<char>(1 << 20);
+    size_t pos = 0, len = 0;
+    explicit LineReader(const std::string &path) : f(fopen(path.c_str(), "rb")) {}
+    ~LineReader() { if (f) fclose(f); }
+    bool next(const char* &line, size_t &n) {
+        for (;;) {
+            const char* nl = (const char*)memchr(buf.data() + pos, '\n', len - pos);
+            if (nl) { line = buf.data() + pos; n = (size_t)(nl - line); pos += n + 1; return true; }
+            if (pos > 0) { memmove(buf.data(), buf.data() + pos, len - pos); len -= pos; pos = 0; }
+            if (len == buf.size()) buf.resize(buf.size() * 2); // a line longer than the buffer
+            size_t got = f ? fread(buf.data() + len, 1, buf.size() - len, f) : 0;
+            if (got == 0) {
+                if (len == 0) return false;
+                line = buf.data(); n = len; pos = len = 0; // last line without a newline
+                return true;
+            }
+            len += got;
+        }
+    }
+};
+
+static void aggregate_user(const UserDir &u, const Week &w, const std::string &runPath, UserRollup &r) {
+    r.user = u.user;
+    LineReader f(u.path + "/daily_logs.txt");
+    if (!f.f) { r.error = "cannot read daily_logs.txt"; return; }
+
+    struct Entry { time_t ts; std::string line; };
+    std::vector<Entry> week;
+    std::map<std::string, std::vector<time_t>> openBreaks;
+    std::string line, type, text;
+    time_t ts = 0;
+    char lastStamp[19] = {}; // timestamp of the last dated line, to close breaks left open
+    const char* p;
+    size_t n;
+    while (f.next(p, n)) {
+        r.bytes += n + 1;
+        ++r.lines;
+        if (n == 0) continue;
+        // The date prefix decides whether the line is in the week without a full parse.
+        int day = -1;
+        bool dated = n >= 19 && p[4] == '-' && p[7] == '-';
+        if (dated) {
+            memcpy(lastStamp, p, sizeof(lastStamp));
+            if (w.days[0].compare(0, 10, p, 10) <= 0 && w.days[7].compare(0, 10, p, 10) > 0) day = day_of_week_index(w, p);
+            if (day < 0) {
+                const char* dash = (n > 22 && memcmp(p + 19, " - ", 3) == 0) ? p + 19 : (const char*)memmem(p, n, " - ", 3);
+                if (!dash || (size_t)(p + n - dash) < 9 || memcmp(dash + 3, "BREAK_", 6) != 0) continue;
+            }
+        }
+        line.assign(p, n);
+        pt_parse_log_line(line, ts, type, text);
+        if (!dated && ts >= w.start && ts < w.end) day = day_of_week_index(w, fmt_local(ts, "%Y-%m-%d").c_str());
+
+        if (type == "BREAK_START" && text.rfind("Started break: ", 0) == 0) {
+            openBreaks[text.substr(15)].push_back(ts);
+        } else if (type == "BREAK_END" && text.rfind("Ended break: ", 0) == 0) {
+            std::string bt = text.substr(13);
+            size_t p = bt.rfind(" (");
+            if (p != std::string::npos) bt.resize(p);
+            auto it = openBreaks.find(bt);
+            if (it != openBreaks.end() && !it->second.empty()) {
+                add_break(r, w, bt, it->second.back(), ts);
+                it->second.pop_back();
+            }
+        } else if (type == "BREAK_RANDOM" && text.rfind("Random break: ", 0) == 0) {
+            std::string rest = text.substr(14);
+            size_t open = rest.rfind(" (");
+            size_t sep = (open == std::string::npos) ? std::string::npos : rest.find(" - ", open);
+            if (sep != std::string::npos)
+                add_break(r, w, rest.substr(0, open), pt_parse_timestamp(rest.substr(open + 2, sep - (open + 2))), pt_parse_timestamp(rest.substr(sep + 3)));
+        }
+        if (day < 0) continue;
+
+        ++r.weekLogs;
+        ++r.byType[type];
+        r.activeDays |= (uint8_t)(1u << day);
+        if (type == "HOURLY") { ++r.hourly; ++r.hourlyPerDay[day]; }
+        Entry e; e.ts = ts;
+        if (dated && line.compare(19, 3, " - ") == 0) e.line.assign(line, 0, 19); // already "YYYY-MM-DD HH:MM:SS"
+        else e.line = fmt_local(ts, "%Y-%m-%d %H:%M:%S");
+        e.line.append(" - ").append(u.user).append(" - ").append(type).append(" - ").append(text);
+        week.push_back(std::move(e));
+    }
+    // Breaks still open are closed at the last logged timestamp, as the app does on migration.
+    time_t lastTs = lastStamp[0] ? pt_parse_timestamp(lastStamp, sizeof(lastStamp)) : ts;
+    for (const auto &kv : openBreaks) for (time_t s : kv.second) add_break(r, w, kv.first, s, lastTs);
+
+    std::ifstream tf(u.path + "/tasks.txt");
+    std::string name; int parent; bool done;
+    while (std::getline(tf, line)) {
+        if (!pt_parse_task_line(line, name, parent, done)) continue;
+        ++r.tasksTotal;
+        if (done) ++r.tasksDone;
+    }
+
+    // daily_logs.txt is appended in time order, so this is usually already sorted.
+    std::stable_sort(week.begin(), week.end(), [](const Entry &a, const Entry &b) { return a.ts < b.ts; });
+    std::ofstream out(runPath, std::ios::binary);
+    if (!out) { r.error = "cannot write " + runPath; return; }
+    for (const auto &e : week) out << (long long)e.ts << '\t' << e.line << '\n';
+    if (!out) { r.error = "cannot write " + runPath; return; }
+    r.run = runPath;
+}
+
+// ----------------------- K-way merge ----------------------------------------
+// Merges sorted run files. Equal timestamps keep input order, so the result is stable.
+// With `final` set the "<ts>\t" prefix is dropped.
+static bool merge_runs(const std::vector<std::string> &inputs, const std::string &outPath, bool final, uint64_t* lines) {
+    struct Source { std::ifstream f; std::string line; long long ts = 0; };
+    std::vector<Source> src(inputs.size());
+    auto advance = [&](size_t i) {
+        Source &s = src[i];
+        if (!std::getline(s.f, s.line)) return false;
+        s.ts = strtoll(s.line.c_str(), nullptr, 10);
+        return true;
+    };
+    typedef std::pair<long long, size_t> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        src[i].f.open(inputs[i], std::ios::binary);
+        if (!src[i].f) { fprintf(stderr, "pt_aggregate: cannot read %s\n", inputs[i].c_str()); return false; }
+        if (advance(i)) heap.push({src[i].ts, i});
+    }
+    std::ofstream out(outPath, std::ios::binary);
+    if (!out) { fprintf(stderr, "pt_aggregate: cannot write %s\n", outPath.c_str()); return false; }
+    uint64_t n = 0;
+    while (!heap.empty()) {
+        size_t i = heap.top().second;
+        heap.pop();
+        const std::string &l = src[i].line;
+        if (final) {
+            size_t tab = l.find('\t');
+            out.write(l.data() + tab + 1, (std::streamsize)(l.size() - tab - 1));
+            out.put('\n');
+        } else {
+            out << l << '\n';
+        }
+        ++n;
+        if (advance(i)) heap.push({src[i].ts, i});
+    }
+    if (lines) *lines = n;
+    return (bool)out;
+}
+
+// Merges any number of runs, in passes of at most kMaxFanIn open files.
+static bool merge_all(std::vector<std::string> runs, const std::string &tmpDir, const std::string &outPath, uint64_t* lines) {
+    for (int pass = 0; runs.size() > kMaxFanIn; ++pass) {
+        std::vector<std::string> next;
+        for (size_t i = 0; i < runs.size(); i += kMaxFanIn) {
+            std::vector<std::string> group(runs.begin() + i, runs.begin() + std::min(runs.size(), i + kMaxFanIn));
+            std::string p = tmpDir + "/merge_" + std::to_string(pass) + "_" + std::to_string(next.size());
+            if (!merge_runs(group, p, false, nullptr)) return false;
+            for (const auto &g : group) unlink(g.c_str());
+            next.push_back(p);
+        }
+        runs.swap(next);
+    }
+    bool ok = merge_runs(runs, outPath, true, lines);
+    for (const auto &g : runs) unlink(g.c_str());
+    return ok;
+}
+
+// ----------------------- Report ---------------------------------------------
+static void write_rollup(std::ostream &o, const Week &w, const UserRollup &r) {
+    static const char* kDays[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    int active = 0;
+    for (int i = 0; i < 7; ++i) if (r.activeDays & (1u << i)) ++active;
+    o << "Log entries: " << r.weekLogs << "   HOURLY: " << r.hourly << "   active days: " << active << "\n";
+    o << "HOURLY per day:";
+    for (int i = 0; i < 7; ++i) {
+        int y, m, d;
+        sscanf(w.days[i].c_str(), "%d-%d-%d", &y, &m, &d);
+        struct tm tm{};
+        time_t t = local_midnight(y, m, d, 0);
+        localtime_r(&t, &tm);
+        o << "  " << kDays[tm.tm_wday] << " " << w.days[i].substr(5) << " " << r.hourlyPerDay[i];
+    }
+    o << "\n";
+    if (!r.byType.empty()) {
+        o << "Entries by type:\n";
+        for (const auto &kv : r.byType) o << "  " << std::left << std::setw(16) << kv.first << " " << kv.second << "\n";
+    }
+    if (!r.breakSeconds.empty()) {
+        o << "Break time by type:\n";
+        for (const auto &kv : r.breakSeconds) o << "  " << std::left << std::setw(16) << kv.first << " " << fmt_duration(kv.second) << "\n";
+    }
+    o << "Tasks: " << r.tasksDone << " done of " << r.tasksTotal << "\n";
+}
+
+// ----------------------- Benchmark data -------------------------------------
+static std::string seed_users(int users, int logsPerUser) {
+    char tmpl[] = "/tmp/pt_aggregate_bench_XXXXXX";
+    if (!mkdtemp(tmpl)) { perror("mkdtemp"); return std::string(); }
+    std::string root = tmpl;
+    static const char* kTypes[] = { "HOURLY", "HOURLY", "HOURLY", "TASK", "EXPORT", "DAILY_STATUS" };
+    static const char* kBreaks[] = { "Coffee", "Lunch", "Walk" };
+    time_t now = time(nullptr);
+    time_t span = 28 * 86400;
+    for (int u = 0; u < users; ++u) {
+        char name[32];
+        snprintf(name, sizeof(name), "user%03d", u);
+        std::string dir = root + "/" + name;
+        mkdir(dir.c_str(), 0700);
+        std::ofstream f(dir + "/daily_logs.txt", std::ios::binary);
+        int onBreak = -1;
+        for (int i = 0; i < logsPerUser; ++i) {
+            time_t t = now - span + (time_t)((double)span * i / std::max(1, logsPerUser)) + u;
+            std::string ts = fmt_local(t, "%Y-%m-%d %H:%M:%S");
+            int k = (i * 7 + u) % 16;
+            if (k == 14 && onBreak < 0) { onBreak = i % 3; f << ts << " - BREAK_START - Started break: " << kBreaks[onBreak] << "\n"; }
+            else if (k == 15 && onBreak >= 0) { f << ts << " - BREAK_END - Ended break: " << kBreaks[onBreak] << " (start " << ts << ", end " << ts << ")\n"; onBreak = -1; }
+            else f << ts << " - " << kTypes[k % 6] << " - worked on PROJ-" << (i % 997) << " with host-" << (u % 13) << "\n";
+        }
+        std::ofstream tf(dir + "/tasks.txt");
+        for (int i = 0; i < 50; ++i) tf << i << ": [" << (i % 3 == 0 ? "x" : " ") << "] Task " << i << (i ? " (parent=0)" : "") << "\n";
+    }
+    return root;
+}
+
+static void remove_tree(const std::string &path) {
+    DIR* d = opendir(path.c_str());
+    if (!d) { unlink(path.c_str()); return; }
+    while (struct dirent* e = readdir(d)) {
+        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+        remove_tree(path + "/" + e->d_name);
+    }
+    closedir(d);
+    rmdir(path.c_str());
+}
+
+// ----------------------- Main -----------------------------------------------
+int main(int argc, char** argv) {
+    std::vector<std::string> args;
+    std::string outDir = ".", weekArg;
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    int seedUsers = 0, seedLogs = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--week" && i + 1 < argc) weekArg = argv[++i];
+        else if (a == "--threads" && i + 1 < argc) threads = std::max(1, atoi(argv[++i]));
+        else if (a == "--out" && i + 1 < argc) outDir = argv[++i];
+        else if (a == "--seed-users" && i + 1 < argc) seedUsers = std::max(0, atoi(argv[++i]));
+        else if (a == "--seed-logs" && i + 1 < argc) seedLogs = std::max(0, atoi(argv[++i]));
+        else if (!a.empty() && a[0] == '-') {
+            fprintf(stderr, "usage: %s [--week YYYY-MM-DD] [--threads N] [--out DIR] DIR...\n"
+                            "       %s --seed-users N --seed-logs M [--threads N]\n", argv[0], argv[0]);
+            return 2;
+        }
+        else args.push_back(a);
+    }
+
+    std::string seeded;
+    if (seedUsers > 0) {
+        auto t0 = std::chrono::steady_clock::now();
+        seeded = seed_users(seedUsers, seedLogs);
+        if (seeded.empty()) return 1;
+        fprintf(stderr, "pt_aggregate: seeded %d users x %d logs in %s (%.2f s)\n", seedUsers, seedLogs, seeded.c_str(), seconds_since(t0));
+        args.push_back(seeded);
+        if (outDir == ".") outDir = seeded;
+    }
+    if (args.empty()) { fprintf(stderr, "pt_aggregate: no data directories given\n"); return 2; }
+
+    int y, m, d;
+    if (!weekArg.empty()) {
+        if (sscanf(weekArg.c_str(), "%4d-%2d-%2d", &y, &m, &d) != 3) { fprintf(stderr, "pt_aggregate: bad --week %s\n", weekArg.c_str()); return 2; }
+    } else {
+        time_t now = time(nullptr);
+        struct tm tm{};
+        localtime_r(&now, &tm);
+        y = tm.tm_year + 1900; m = tm.tm_mon + 1; d = tm.tm_mday - 6;
+    }
+    Week week = make_week(y, m, d);
+
+    std::vector<UserDir> dirs;
+    for (const auto &a : args) discover(a, dirs);
+    if (dirs.empty()) { fprintf(stderr, "pt_aggregate: no data directories found\n"); return 1; }
+
+    std::string tmpl = outDir + "/.pt_aggregate_XXXXXX";
+    std::vector<char> tmpBuf(tmpl.begin(), tmpl.end());
+    tmpBuf.push_back('\0');
+    if (!mkdtemp(tmpBuf.data())) { perror(outDir.c_str()); return 1; }
+    std::string tmpDir = tmpBuf.data();
+
+    // Per-directory jobs on a fixed pool; workers pull the next index until none are left.
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<UserRollup> rollups(dirs.size());
+    std::atomic<size_t> nextDir(0);
+    std::vector<std::thread> pool;
+    int workers = std::min<int>(threads, (int)dirs.size());
+    for (int t = 0; t < workers; ++t) {
+        pool.emplace_back([&]() {
+            for (size_t i; (i = nextDir.fetch_add(1)) < dirs.size(); )
+                aggregate_user(dirs[i], week, tmpDir + "/run_" + std::to_string(i), rollups[i]);
+        });
+    }
+    for (auto &th : pool) th.join();
+    double parseSecs = seconds_since(t0);
+
+    UserRollup team;
+    std::vector<std::string> runs;
+    for (const auto &r : rollups) {
+        if (!r.error.empty()) { fprintf(stderr, "pt_aggregate: %s: %s\n", r.user.c_str(), r.error.c_str()); continue; }
+        runs.push_back(r.run);
+        team.bytes += r.bytes; team.lines += r.lines; team.weekLogs += r.weekLogs; team.hourly += r.hourly;
+        for (int i = 0; i < 7; ++i) team.hourlyPerDay[i] += r.hourlyPerDay[i];
+        team.activeDays |= r.activeDays;
+        for (const auto &kv : r.byType) team.byType[kv.first] += kv.second;
+        for (const auto &kv : r.breakSeconds) team.breakSeconds[kv.first] += kv.second;
+        team.tasksTotal += r.tasksTotal; team.tasksDone += r.tasksDone;
+    }
+    fprintf(stderr, "pt_aggregate: %zu dirs, %llu lines, %.1f MB in %.3f s with %d threads (%.0f MB/s, %.0f lines/s)\n",
+            dirs.size(), (unsigned long long)team.lines, team.bytes / 1048576.0, parseSecs, workers,
+            team.bytes / 1048576.0 / std::max(parseSecs, 1e-9), team.lines / std::max(parseSecs, 1e-9));
+
+    std::string base = outDir + "/team_weekly_" + week.days[0];
+    auto t1 = std::chrono::steady_clock::now();
+    uint64_t merged = 0;
+    bool ok = merge_all(runs, tmpDir, base + "_logs.txt", &merged);
+    double mergeSecs = seconds_since(t1);
+    fprintf(stderr, "pt_aggregate: merged %llu week entries from %zu runs in %.3f s (%.0f lines/s)\n",
+            (unsigned long long)merged, runs.size(), mergeSecs, merged / std::max(mergeSecs, 1e-9));
+    rmdir(tmpDir.c_str());
+
+    std::ofstream rep(base + ".txt");
+    if (!rep) { fprintf(stderr, "pt_aggregate: cannot write %s.txt\n", base.c_str()); return 1; }
+    int userDays = 0;
+    for (const auto &r : rollups) for (int i = 0; i < 7; ++i) if (r.activeDays & (1u << i)) ++userDays;
+    rep << "Team weekly report: " << week.days[0] << " .. " << week.days[6] << " (" << runs.size() << " users)\n";
+    rep << "Generated: " << fmt_local(time(nullptr), "%Y-%m-%d %H:%M:%S") << "\n\n";
+    rep << "== Team ==\n";
+    rep << "Active user-days: " << userDays << "\n";
+    write_rollup(rep, week, team);
+    for (const auto &r : rollups) {
+        if (!r.error.empty()) continue;
+        rep << "\n== " << r.user << " ==\n";
+        write_rollup(rep, week, r);
+    }
+    rep.close();
+    printf("%s.txt\n%s_logs.txt\n", base.c_str(), base.c_str());
+    if (!seeded.empty() && outDir != seeded) remove_tree(seeded);
+    return ok && rep ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+// pt_status.cpp
+// Prints the running tracker's session status from the shared-memory status page.
+// Meant for status bars (polybar, tmux): after startup each read is a few loads from
+// the mapping, with no system calls (one kill(pid, 0) only once the tracker's heartbeat
+// is stale).
+//
+// Usage: pt_status [--json] [--watch SECONDS] [--dir DATA_DIR]
+//   default   "02:13:05" or "02:13:05 (Coffee 04:10)" while on a break
+//   --json    one JSON object per read
+//   --watch   keep printing every SECONDS seconds; follows tracker restarts
+//   --dir     the tracker's data dir (default: PT_DATA_DIR, else ~/.productivity_tracker)
+// Exit code 1 if the tracker is not running.
+
+#include "status_page.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <chrono>
+
+static std::string hms(int64_t s) {
+    if (s < 0) s = 0;
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%02lld:%02lld:%02lld", (long long)(s / 3600), (long long)(s / 60 % 60), (long long)(s % 60));
+    return buf;
+}
+
+static std::string json_escape(const char* s) {
+    std::string out;
+    for (; *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') { out += '\\'; out += (char)c; }
+        else if (c < 0x20) { char buf[8]; snprintf(buf, sizeof(buf), "\\u%04x", c); out += buf; }
+        else out += (char)c;
+    }
+    return out;
+}
+
+static bool print_status(const PtStatusPage* page, bool json) {
+    PtStatus st;
+    int64_t now = (int64_t)time(nullptr);
+    if (!page || !pt_status_read(page, &st) || !pt_status_running(st, now)) {
+        if (json) printf("{\"running\":false}\n");
+        else printf("not running\n");
+        return false;
+    }
+    if (json) {
+        printf("{\"running\":true,\"tracking\":%s,\"tracked_seconds\":%lld,\"session_start\":%lld,"
+               "\"active_breaks\":%u,\"break_type\":\"%s\",\"break_start\":%lld,\"last_hourly_log\":%lld}\n",
+               st.tracking ? "true" : "false", (long long)st.tracked_seconds(now), (long long)st.session_start_time,
+               st.active_breaks, json_escape(st.active_break_type).c_str(), (long long)st.active_break_start, (long long)st.last_hourly_log_time);
+    } else if (st.active_breaks > 0) {
+        printf("%s (%s %s)\n", hms(st.tracked_seconds(now)).c_str(), st.active_break_type,
+               hms(now - st.active_break_start).c_str() + 3); // mm:ss
+    } else {
+        printf("%s\n", hms(st.tracked_seconds(now)).c_str());
+    }
+    fflush(stdout);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool json = false;
+    int watch = 0;
+    std::string dataDir = pt_status_data_dir();
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--json") json = true;
+        else if (a == "--watch" && i + 1 < argc) watch = std::max(1, atoi(argv[++i]));
+        else if (a == "--dir" && i + 1 < argc) dataDir = argv[++i];
+        else { fprintf(stderr, "usage: %s [--json] [--watch SECONDS] [--dir DATA_DIR]\n", argv[0]); return 2; }
+    }
+#ifndef _WIN32
+    const PtStatusPage* page = pt_status_open_readonly(dataDir);
+    bool ok = print_status(page, json);
+    while (watch > 0) {
+        std::this_thread::sleep_for(std::chrono::seconds(watch));
+        // A stopped tracker unlinks its page and the next one creates a new object:
+        // drop the old mapping and look the name up again
+        if (!ok) {
+            pt_status_close(page);
+            page = pt_status_open_readonly(dataDir);
+        }
+        ok = print_status(page, json);
+    }
+    pt_status_close(page);
+    return ok ? 0 : 1;
+#else
+    fprintf(stderr, "pt_status is not available on Windows\n");
+    return 1;
+#endif
+}
@@ -0,0 +1,177 @@
+// status_page.h
+// Productivity Tracker - shared-memory status page (POSIX).
+// The running tracker publishes a small struct in POSIX shared memory whenever the
+// session state changes. Status bars read it through a read-only mapping: after the
+// initial shm_open + mmap, reading costs no system calls.
+//
+// Consistency: a seqlock. The writer makes `seq` odd, updates the fields, then makes
+// it even again; readers copy the fields and retry if `seq` was odd or changed.
+//
+// One page per user and data directory (PT_DATA_DIR), so trackers on different data
+// dirs never share or unlink each other's page. A tracker that crashed leaves its pid
+// behind, so the tracker also bumps `heartbeat` every second; readers trust a fresh
+// heartbeat and only check the pid (one kill(pid, 0)) once it has gone stale.
+//
+// Used by main.cpp (writer) and pt_status.cpp (reader CLI). Header-only.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#ifndef _WIN32
+  #include <cerrno>
+  #include <climits>
+  #include <fcntl.h>
+  #include <signal.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+static const uint32_t PT_STATUS_MAGIC = 0x54535450; // "PTST"
+static const uint32_t PT_STATUS_VERSION = 2;
+static const int64_t PT_STATUS_HEARTBEAT_STALE = 5; // seconds without a heartbeat before the pid is checked
+
+struct PtStatusPage {
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> seq;       // odd while the writer is updating
+    uint32_t pid;                    // tracker process, 0 once it has exited
+    // fields below are only meaningful for an even, unchanged seq
+    uint32_t tracking;               // 1 while the session timer runs (not in a break)
+    uint32_t active_breaks;
+    int64_t accumulated_tracked_seconds;
+    int64_t tracking_start_time;     // unix time tracking last resumed, 0 when paused
+    int64_t session_start_time;
+    int64_t active_break_start;      // most recent active break, 0 if none
+    int64_t last_hourly_log_time;    // 0 if none
+    int64_t updated_at;
+    char active_break_type[64];
+    std::atomic<int64_t> heartbeat;  // unix time, refreshed every second outside the seqlock
+};
+
+// Plain copy of the fields, as seen by a reader.
+struct PtStatus {
+    uint32_t pid;
+    uint32_t tracking;
+    uint32_t active_breaks;
+    int64_t accumulated_tracked_seconds;
+    int64_t tracking_start_time;
+    int64_t session_start_time;
+    int64_t active_break_start;
+    int64_t last_hourly_log_time;
+    int64_t updated_at;
+    char active_break_type[64];
+    int64_t heartbeat;
+
+    int64_t tracked_seconds(int64_t now) const {
+        return accumulated_tracked_seconds + (tracking_start_time ? now - tracking_start_time : 0);
+    }
+};
+
+// The tracker's data directory, resolved as main.cpp does: PT_DATA_DIR, else
+// ~/.productivity_tracker.
+static inline std::string pt_status_data_dir() {
+    const char* over = getenv("PT_DATA_DIR");
+    if (over && *over) return over;
+    const char* home = getenv("HOME");
+    return home ? std::string(home) + "/.productivity_tracker" : std::string(".");
+}
+
+// Object name for a data dir: uid + FNV-1a of the canonical path, short enough for
+// macOS (31 chars).
+static inline void pt_status_shm_name(const std::string &dataDir, char* out, size_t n) {
+    std::string dir = dataDir;
+#ifndef _WIN32
+    char real[PATH_MAX];
+    if (realpath(dataDir.c_str(), real)) dir = real;
+#endif
+    uint32_t h = 2166136261u;
+    for (unsigned char c : dir) { h ^= c; h *= 16777619u; }
+#ifndef _WIN32
+    snprintf(out, n, "/pt_status.%u.%08x", (unsigned)getuid(), h);
+#else
+    snprintf(out, n, "pt_status.%08x", h);
+#endif
+}
+
+// Writer side: call with the fields already filled into `s`.
+static inline void pt_status_write(PtStatusPage* page, const PtStatus &s) {
+    uint32_t seq = page->seq.load(std::memory_order_relaxed);
+    page->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    page->pid = s.pid;
+    page->tracking = s.tracking;
+    page->active_breaks = s.active_breaks;
+    page->accumulated_tracked_seconds = s.accumulated_tracked_seconds;
+    page->tracking_start_time = s.tracking_start_time;
+    page->session_start_time = s.session_start_time;
+    page->active_break_start = s.active_break_start;
+    page->last_hourly_log_time = s.last_hourly_log_time;
+    page->updated_at = s.updated_at;
+    std::memcpy(page->active_break_type, s.active_break_type, sizeof(page->active_break_type));
+    page->active_break_type[sizeof(page->active_break_type) - 1] = '\0';
+    page->seq.store(seq + 2, std::memory_order_release);
+}
+
+// Reader side: returns false if the page is not a status page or the writer kept it
+// busy for every attempt.
+static inline bool pt_status_read(const PtStatusPage* page, PtStatus* out) {
+    if (page->magic != PT_STATUS_MAGIC || page->version != PT_STATUS_VERSION) return false;
+    for (int attempt = 0; attempt < 1000; ++attempt) {
+        uint32_t before = page->seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        out->pid = page->pid;
+        out->tracking = page->tracking;
+        out->active_breaks = page->active_breaks;
+        out->accumulated_tracked_seconds = page->accumulated_tracked_seconds;
+        out->tracking_start_time = page->tracking_start_time;
+        out->session_start_time = page->session_start_time;
+        out->active_break_start = page->active_break_start;
+        out->last_hourly_log_time = page->last_hourly_log_time;
+        out->updated_at = page->updated_at;
+        std::memcpy(out->active_break_type, page->active_break_type, sizeof(out->active_break_type));
+        out->heartbeat = page->heartbeat.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (page->seq.load(std::memory_order_relaxed) == before) {
+            out->active_break_type[sizeof(out->active_break_type) - 1] = '\0';
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifndef _WIN32
+// False for 0 and for the pid of a tracker that exited without clearing it.
+static inline bool pt_status_pid_alive(uint32_t pid) {
+    return pid != 0 && (kill((pid_t)pid, 0) == 0 || errno == EPERM);
+}
+
+// True while the tracker that wrote `s` runs. No system call while the heartbeat is fresh.
+static inline bool pt_status_running(const PtStatus &s, int64_t now) {
+    if (s.pid == 0) return false;
+    return now - s.heartbeat <= PT_STATUS_HEARTBEAT_STALE || pt_status_pid_alive(s.pid);
+}
+
+// Maps the page read-only; returns nullptr if the tracker has not created it.
+static inline const PtStatusPage* pt_status_open_readonly(const std::string &dataDir = pt_status_data_dir()) {
+    char name[64];
+    pt_status_shm_name(dataDir, name, sizeof(name));
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(PtStatusPage)) { close(fd); return nullptr; }
+    void* p = mmap(nullptr, sizeof(PtStatusPage), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return p == MAP_FAILED ? nullptr : (const PtStatusPage*)p;
+}
+
+static inline void pt_status_close(const PtStatusPage* page) {
+    if (page) munmap((void*)page, sizeof(PtStatusPage));
+}
+#endif